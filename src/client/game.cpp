@@ -7,6 +7,8 @@
 #include <optional>
 #include <variant>
 #include <array>
+#include <cstdint>
+#include <unordered_set>
 #include "pgnparser.h"
 #include "hypercuboid.h"
 #include "variants.h"
@@ -351,20 +353,23 @@ std::pair<int, int> game::get_board_size() const
 bool game::suggest_action()
 {
     const state &s = current_node->get_state();
+    std::unordered_set<std::uint64_t> known;
+    for(const auto &child : current_node->get_children())
+    {
+        known.insert(child->get_action().canonical_hash());
+    }
     auto [w, ss] = HC_info::build_HC(s);
-    for(moveseq mvs : w.search(ss))
+    for(const moveseq &mvs : w.search(ss))
     {
-        std::vector<ext_move> emvs;
-        std::transform(mvs.begin(), mvs.end(), std::back_inserter(emvs), [](full_move m){
-            return ext_move(m);
-        });
-        action act = action::from_vector(emvs, s);
-        if(!current_node->find_child(act))
+        // only a hash shared with an existing child needs the full comparison
+        if(known.contains(canonical_hash(mvs))
+           && current_node->find_child(action::from_moveseq(mvs, s)))
         {
-            visit_child(act);
-            visit_parent();
-            return true;
+            continue;
         }
+        visit_child(action::from_moveseq(mvs, s));
+        visit_parent();
+        return true;
     }
     return false;
 }
@@ -436,7 +441,7 @@ bool game::visit_child(action act, comments_t comments, std::optional<state> new
     auto &children = current_node->get_children();
     for(auto &child : children)
     {
-        if(child->get_action().get_moves() == act.get_moves())
+        if(child->get_action().same_moves(act))
         {
             current_node = child.get();
             fresh();
@@ -1,4 +1,5 @@
 #include "action.h"
+#include <algorithm>
 #include <cstdio>
 #include <sstream>
 #include "utils.h"
@@ -138,6 +139,60 @@ std::string ext_move::lan(const state &s) const
 
 /*********************************/
 
+namespace
+{
+
+std::uint64_t pack(vec4 v)
+{
+    return (static_cast<std::uint64_t>(static_cast<unsigned>(v.l()) & 0xfff) << 20)
+         | (static_cast<std::uint64_t>(static_cast<unsigned>(v.t()) & 0xfff) << 8)
+         | (static_cast<std::uint64_t>(v.y() & 0xf) << 4)
+         | static_cast<std::uint64_t>(v.x() & 0xf);
+}
+
+// splitmix64 finalizer
+std::uint64_t mix(std::uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+std::uint64_t move_hash(const full_move &fm, piece_t promote_to)
+{
+    return mix((pack(fm.from) << 32 | pack(fm.to))
+               ^ static_cast<std::uint64_t>(promote_to) * 0x9e3779b97f4a7c15ULL);
+}
+
+} /* anonymous namespace */
+
+// summing the move hashes makes the result independent of the order
+std::uint64_t canonical_hash(const moveseq &mvs)
+{
+    std::uint64_t sum = mvs.size();
+    for(const full_move &fm : mvs)
+    {
+        sum += move_hash(fm, QUEEN_W);
+    }
+    return mix(sum);
+}
+
+std::uint64_t action::canonical_hash() const
+{
+    std::uint64_t sum = mvs.size();
+    for(const ext_move &mv : mvs)
+    {
+        sum += move_hash(mv.fm, mv.promote_to);
+    }
+    return mix(sum);
+}
+
+bool action::same_moves(const action &other) const
+{
+    return mvs.size() == other.mvs.size()
+        && std::is_permutation(mvs.begin(), mvs.end(), other.mvs.begin());
+}
+
 int action::sort(std::vector<ext_move> &mvs, const state &s)
 {
     size_t rbranching_index = 0;
@@ -1,6 +1,7 @@
 #ifndef ACTION_H
 #define ACTION_H
 
+#include <cstdint>
 #include <variant>
 #include <tuple>
 #include <set>
@@ -78,6 +79,15 @@ struct ext_move
 /* move sequence (used in hypercuboid.h) */
 using moveseq = std::vector<full_move>;
 
+/*
+ canonical_hash(mvs): a hash of the set of moves in `mvs`. It does not depend
+ on the order of the moves, so every ordering of one action hashes to the same
+ value and no `action` needs to be built. The moves are taken to promote to a
+ queen, like `action::from_moveseq()` does; `action::canonical_hash()` agrees
+ with it.
+ */
+std::uint64_t canonical_hash(const moveseq &mvs);
+
 /*
  An action is a sequence of extended moves sorted in standard order
  `branching_index` is the index of index branching move
@@ -114,6 +124,12 @@ public:
     constexpr static pgn_options DEFAULT_PGN_OPTIONS = pgn_options::SHOW_CAPTURE | pgn_options::SHOW_PROMOTION;
     pgn_adv_res pgn_advanced(const state &, pgn_options options=DEFAULT_PGN_OPTIONS) const;
     pgn_adv_res pgn_advanced(const state &, pgn_options options, const action &witness) const;
+    // order-independent hash of the moves, see canonical_hash(const moveseq&)
+    std::uint64_t canonical_hash() const;
+    /* same_moves(other): whether both actions consist of the same moves,
+    possibly listed in a different order; unlike operator==, this matches an
+    action entered move by move against the same action found by search */
+    bool same_moves(const action &other) const;
     bool operator ==(const action &other) const = default;
     friend std::ostream &operator<<(std::ostream &os, const action &act);
 };
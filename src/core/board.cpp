@@ -1,4 +1,5 @@
 #include "board.h"
+#include "utils.h"
 #include <algorithm>
 #include <string>
 #include <iostream>
@@ -21,6 +22,16 @@ board::board(std::string fen, int size_x, int size_y) : bbs{}, umove_mask{0}
     }
 }
 
+std::uint64_t board::hash() const
+{
+    std::uint64_t h = umove_mask;
+    for(bitboard_t bb : bbs)
+    {
+        h = hash_mix(h ^ bb);
+    }
+    return h;
+}
+
 piece_t board::get_piece(int pos) const
 {
     piece_t piece;
@@ -10,6 +10,7 @@
 
 #include <iostream>
 #include <array>
+#include <cstdint>
 #include <string>
 #include "piece.h"
 #include "bitboard.h"
@@ -103,6 +104,8 @@ public:
     std::shared_ptr<board> move_piece(int from, int to) const;
     array_board to_array_board() const;
     std::string to_string() const;
+    // hash of the pieces and the unmoved flags
+    std::uint64_t hash() const;
     
     template<bool SHOW_UMOVE=false>
     std::string get_fen() const;
@@ -2,6 +2,7 @@
 #define FINETREE_H
 
 #include <concepts>
+#include <cstdint>
 #include <memory>
 #include <deque>
 #include <optional>
@@ -12,8 +13,10 @@
 #include "state.h"
 #include "geometry.h"
 #include "hypercuboid.h"
+#include "history_ordering.h"
 #include "integer_set.h"
 #include "generator.h"
+#include "utils.h"
 
 template<typename T = std::monostate>
     requires std::default_initializable<T>
@@ -85,6 +88,8 @@ class fine_node
     void remove_from_node(const slice&, fine_node<T>*, fine_cell<T>* critical_cell, bool force_critical_removal);
     fine_node<T> *isolate(point, fine_cell<T>*, HC*);
     fine_node<T> *normalize(point, fine_cell<T>*, fine_node<T>*);
+    fine_node(std::unique_ptr<nodal_pocession<T>> ctx, T info); /* used by detach */
+    friend struct nodal_pocession<T>; /* for memory_usage */
 
 public:
     // copying/moving a fine_node needs to explicitly set the parent pointer of its children
@@ -101,7 +106,15 @@ public:
     static std::unique_ptr<fine_node<T>> make_temproary(fine_node *parent, index_t n, index_t i, T info = T{});
 
     // -- factory -- //
-    static std::unique_ptr<fine_node<T>> make_root(state s, T info = T{});
+    /* with `history_guided`, this node and every node ignited below it take
+     points under a history_HC_ordering instead of the natural order; they
+     all share one semimove_history owned by the tree, which a detached root
+     keeps */
+    static std::unique_ptr<fine_node<T>> make_root(state s, T info = T{}, bool history_guided = false);
+    /* this node and every node ignited below it take points in a random
+     order; each possession shuffles its axes with a generator seeded by
+     `shuffle_seed` and the hash of its state, so equal seeds grow equal trees */
+    static std::unique_ptr<fine_node<T>> make_shuffled_root(state s, std::uint32_t shuffle_seed, T info = T{});
 
     // -- queries -- //
     bool is_nodal() const { return pocessed_context != nullptr; }
@@ -129,6 +142,14 @@ public:
     returns true if the node is not terminal
      */
     bool gen_all_children();
+    /* detach: only for ignited ceiling nodes. Returns a new root which takes
+     over this node's context, info and children; this node is left childless
+     and the tree that owns it can be freed. */
+    std::unique_ptr<fine_node<T>> detach();
+    /* extinguish: undo ignite() on a ceiling node, freeing its context with
+     every node below it. The node's info is kept; a later ignite() starts
+     the subtree over. */
+    void extinguish();
     std::string to_string() const;
 };
 
@@ -142,6 +163,17 @@ struct nodal_pocession
     + true if no further expansion is possible
     + false if not terminal or not yet verified
     */
+    std::optional<history_HC_ordering> ordering; // natural order if empty
+    std::shared_ptr<semimove_history> history; // the table `ordering` learns in
+    std::optional<random_HC_ordering> shuffled; // used if set and `ordering` is empty
+    std::uint32_t shuffle_seed;
+
+    void shuffle(std::uint32_t seed); /* sets `shuffled`, see make_shuffled_root() */
+
+    /* memory_usage(): estimated bytes held by this possession and the nodes
+     and cells in its pools, not counting the possessions of nodes ignited
+     below it */
+    std::size_t memory_usage() const;
 };
 
 #include "finetree.inl"
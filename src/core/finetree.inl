@@ -25,7 +25,11 @@ inline fine_node<T>::fine_node(
                 .subspace = std::move(ss)
             }
         },
-        .verified_terminal = false
+        .verified_terminal = false,
+        .ordering = std::nullopt,
+        .history = nullptr,
+        .shuffled = std::nullopt,
+        .shuffle_seed = 0
     });
     cells.push_back(&pocessed_context->cell_pool.back());
 }
@@ -44,12 +48,47 @@ template<typename T>
     requires std::default_initializable<T>
 inline std::unique_ptr<fine_node<T>> fine_node<T>::make_root(
     state s,
+    T info,
+    bool history_guided)
+{
+    auto root = std::unique_ptr<fine_node<T>>(
+        new fine_node(nullptr, s, std::move(info)));
+    if(history_guided)
+    {
+        nodal_pocession<T> &ctx = *root->pocessed_context;
+        ctx.history = std::make_shared<semimove_history>();
+        ctx.ordering.emplace(ctx.hc_info, *ctx.history);
+    }
+    return root;
+}
+
+template<typename T>
+    requires std::default_initializable<T>
+inline std::unique_ptr<fine_node<T>> fine_node<T>::make_shuffled_root(
+    state s,
+    std::uint32_t shuffle_seed,
     T info)
 {
-    return std::unique_ptr<fine_node<T>>(
+    auto root = std::unique_ptr<fine_node<T>>(
         new fine_node(nullptr, s, std::move(info)));
+    root->pocessed_context->shuffle(shuffle_seed);
+    return root;
 }
 
+template<typename T>
+    requires std::default_initializable<T>
+inline void nodal_pocession<T>::shuffle(std::uint32_t seed)
+{
+    std::mt19937 rng(static_cast<std::uint32_t>(hash_mix(seed ^ hc_info.s.hash())));
+    shuffle_seed = seed;
+    shuffled.emplace(hc_info.universe, rng);
+}
+
+template<typename T>
+    requires std::default_initializable<T>
+inline fine_node<T>::fine_node(std::unique_ptr<nodal_pocession<T>> ctx, T info_value)
+: parent{nullptr}, pocessed_context{std::move(ctx)}, context{nullptr}, n{index_t(-7)}, i{index_t(-7)}, cells{}, next_cell_index{0}, info{std::move(info_value)} {}
+
 template<typename T>
     requires std::default_initializable<T>
 inline std::unique_ptr<fine_node<T>> fine_node<T>::make_temproary(fine_node *parent, index_t n, index_t i, T info)
@@ -244,7 +283,8 @@ template<typename T>
     requires std::default_initializable<T>
 inline std::optional<std::tuple<point, fine_cell<T> *, HC *>> fine_node<T>::explore()
 {
-    HC_info &hc_info = get_context()->hc_info;
+    nodal_pocession<T> *ctx = get_context();
+    HC_info &hc_info = ctx->hc_info;
     std::size_t consecutive_empty_cells = 0;
     while(!cells.empty()
           && consecutive_empty_cells < cells.size())
@@ -264,7 +304,9 @@ inline std::optional<std::tuple<point, fine_cell<T> *, HC *>> fine_node<T>::expl
         consecutive_empty_cells = 0;
 
         HC &hc = cell->subspace.back();
-        auto pt_opt = hc_info.take_point(hc);
+        auto pt_opt = ctx->ordering ? hc_info.take_point(hc, *ctx->ordering)
+            : ctx->shuffled ? hc_info.take_point(hc, *ctx->shuffled)
+            : hc_info.take_point(hc);
         if(!pt_opt)
         {
             cell->subspace.pop_back();
@@ -272,6 +314,10 @@ inline std::optional<std::tuple<point, fine_cell<T> *, HC *>> fine_node<T>::expl
         }
 
         auto problem = hc_info.find_problem(*pt_opt, hc);
+        if(ctx->ordering)
+        {
+            ctx->ordering->observe(*pt_opt, problem);
+        }
         if(problem)
         {
             remove_problem(*problem, cell);
@@ -468,14 +514,83 @@ inline void fine_node<T>::ignite()
                 .subspace = std::move(ss)
             }
         },
-        .verified_terminal = false
+        .verified_terminal = false,
+        .ordering = std::nullopt,
+        .history = nullptr,
+        .shuffled = std::nullopt,
+        .shuffle_seed = 0
     });
+    if(context->ordering)
+    {
+        // keep learning in the table of the tree, whichever thread ignites
+        pocessed_context->history = context->history;
+        pocessed_context->ordering.emplace(pocessed_context->hc_info, *pocessed_context->history);
+    }
+    else if(context->shuffled)
+    {
+        pocessed_context->shuffle(context->shuffle_seed);
+    }
     // clear the old cells which are related to the old context
     cells.clear();
     next_cell_index = 0;
     cells.push_back(&pocessed_context->cell_pool.back());
 }
 
+template<typename T>
+    requires std::default_initializable<T>
+inline std::unique_ptr<fine_node<T>> fine_node<T>::detach()
+{
+    assert(is_nodal() && is_ceiling());
+    auto root = std::unique_ptr<fine_node<T>>(
+        new fine_node(std::move(pocessed_context), std::move(info)));
+    // the pools live in the context, so only the pointers to this node change
+    root->cells = std::move(cells);
+    root->next_cell_index = next_cell_index;
+    root->children = std::move(children);
+    cells.clear();
+    children.clear();
+    for(fine_cell<T> *cell : root->cells)
+    {
+        cell->node = root.get();
+    }
+    for(fine_node<T> *child : root->children)
+    {
+        child->parent = root.get();
+    }
+    return root;
+}
+
+template<typename T>
+    requires std::default_initializable<T>
+inline void fine_node<T>::extinguish()
+{
+    assert(is_nodal() && is_ceiling());
+    // the old cells were cleared by ignite()
+    cells.clear();
+    next_cell_index = 0;
+    children.clear();
+    pocessed_context.reset();
+}
+
+template<typename T>
+    requires std::default_initializable<T>
+inline std::size_t nodal_pocession<T>::memory_usage() const
+{
+    std::size_t result = sizeof(nodal_pocession<T>) + hc_info.memory_usage() - sizeof(HC_info);
+    for(const fine_node<T> &node : node_pool)
+    {
+        result += sizeof(fine_node<T>)
+            + node.children.capacity() * sizeof(fine_node<T>*)
+            + node.cells.capacity() * sizeof(fine_cell<T>*);
+    }
+    for(const fine_cell<T> &cell : cell_pool)
+    {
+        result += sizeof(fine_cell<T>) - sizeof(HC) - sizeof(search_space)
+            + cell.space.memory_usage() + cell.subspace.memory_usage();
+    }
+    return result;
+}
+
 template<typename T>
     requires std::default_initializable<T>
 inline moveseq fine_node<T>::to_action()
@@ -72,7 +72,7 @@ public:
     {
         for(const auto &child : children)
         {
-            if(a == child->act)
+            if(a.same_moves(child->act))
             {
                 return child.get();
             }
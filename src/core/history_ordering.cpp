@@ -0,0 +1,146 @@
+#include "history_ordering.h"
+#include <algorithm>
+
+namespace
+{
+
+constexpr std::uint32_t history_count_limit = 1u << 16;
+
+} /* anonymous namespace */
+
+semimove_history &semimove_history::local()
+{
+    static thread_local semimove_history history;
+    return history;
+}
+
+void semimove_history::reset()
+{
+    *this = semimove_history{};
+}
+
+void semimove_history::record(feature_t f, bool was_accepted)
+{
+    std::uint32_t &count = was_accepted ? accepted[f] : rejected[f];
+    count++;
+    if(count >= history_count_limit)
+    {
+        accepted[f] /= 2;
+        rejected[f] /= 2;
+    }
+}
+
+double semimove_history::score(feature_t f) const
+{
+    return (accepted[f] + 1.0) / (accepted[f] + rejected[f] + 2.0);
+}
+
+semimove_history::feature_t semimove_history::feature_of(const HC_info &info, index_t n, index_t i)
+{
+    const int kind = info.get_semimove(n, i).visit(overloads {
+        [](const physical_move &) { return 0; },
+        [](const arriving_move &) { return 1; },
+        [](const departing_move &) { return 2; },
+        [](const null_move &) { return 3; },
+    });
+    const piece_t p = to_white(piece_name(info.moved_piece(n, i)));
+    const int check = info.gives_check(n, i) ? 1 : 0;
+    return static_cast<feature_t>((kind * 2 + check) * 128 + (p & 0x7f));
+}
+
+history_HC_ordering::history_HC_ordering(const HC_info &info, semimove_history &history)
+    : history(&history)
+{
+    collect_features(info);
+    sort_axes();
+}
+
+history_HC_ordering::history_HC_ordering(const HC_info &info, std::mt19937 &rng, semimove_history &history)
+    : history(&history)
+{
+    collect_features(info);
+    // break ties randomly: shuffle, then sort keeping the shuffled order
+    for(std::vector<index_t> &ordering : orderings)
+    {
+        std::shuffle(ordering.begin(), ordering.end(), rng);
+    }
+    sort_axes();
+}
+
+void history_HC_ordering::collect_features(const HC_info &info)
+{
+    const HC &universe = info.universe;
+    orderings.resize(universe.dimension());
+    features.resize(universe.dimension());
+    std::array<bool, semimove_history::feature_count> seen{};
+    for(index_t n = 0; n < universe.dimension(); n++)
+    {
+        orderings[n].assign(universe[n].begin(), universe[n].end());
+        if(!orderings[n].empty())
+        {
+            features[n].resize(orderings[n].back() + 1);
+        }
+        for(index_t i : orderings[n])
+        {
+            const semimove_history::feature_t f = semimove_history::feature_of(info, n, i);
+            features[n][i] = f;
+            if(!seen[f])
+            {
+                seen[f] = true;
+                present_features.push_back(f);
+            }
+        }
+    }
+}
+
+void history_HC_ordering::sort_axes()
+{
+    // rank the few features that occur, then counting-sort every axis by
+    // rank; the sort is stable, so equal features keep their current order
+    std::stable_sort(present_features.begin(), present_features.end(),
+        [&](semimove_history::feature_t a, semimove_history::feature_t b) {
+            return history->score(a) > history->score(b);
+        });
+    std::array<std::uint16_t, semimove_history::feature_count> rank{};
+    for(std::size_t r = 0; r < present_features.size(); r++)
+    {
+        rank[present_features[r]] = static_cast<std::uint16_t>(r);
+    }
+    std::vector<std::size_t> starts;
+    std::vector<index_t> sorted;
+    for(std::size_t n = 0; n < orderings.size(); n++)
+    {
+        const auto &axis_features = features[n];
+        starts.assign(present_features.size() + 1, 0);
+        for(index_t i : orderings[n])
+        {
+            starts[rank[axis_features[i]] + 1]++;
+        }
+        for(std::size_t r = 1; r < starts.size(); r++)
+        {
+            starts[r] += starts[r - 1];
+        }
+        sorted.resize(orderings[n].size());
+        for(index_t i : orderings[n])
+        {
+            sorted[starts[rank[axis_features[i]]]++] = i;
+        }
+        orderings[n].swap(sorted);
+    }
+}
+
+void history_HC_ordering::observe(const point &p, const std::optional<slice> &problem) const
+{
+    if(!problem)
+    {
+        for(std::size_t n = 0; n < p.size(); n++)
+        {
+            history->record(features[n][p[n]], true);
+        }
+        return;
+    }
+    for(const auto &[n, _] : problem->get_fixed_axes())
+    {
+        history->record(features[n][p[n]], false);
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef HISTORY_ORDERING_H
+#define HISTORY_ORDERING_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <vector>
+#include "geometry.h"
+#include "hypercuboid.h"
+
+/*
+ `semimove_history` remembers how often semimoves of each kind were part of
+ an accepted point or of a rejected problem slice. Semimoves are grouped by
+ a small feature: the kind of the entry (physical, arriving, departing or
+ null), the moving piece (colour removed) and whether the move attacks an
+ enemy royal piece on the board it lands on.
+
+ Every thread has its own table, so searches on different threads never
+ share counters. Counts are halved once they grow large, so old searches
+ fade out as new positions come in.
+ */
+struct semimove_history
+{
+    using feature_t = std::uint16_t;
+    static constexpr std::size_t feature_count = 4 * 2 * 128;
+
+    std::array<std::uint32_t, feature_count> accepted{};
+    std::array<std::uint32_t, feature_count> rejected{};
+
+    // table of the calling thread
+    static semimove_history &local();
+    void reset();
+    void record(feature_t f, bool was_accepted);
+    // estimated probability that an entry with feature `f` survives
+    double score(feature_t f) const;
+
+    static feature_t feature_of(const HC_info &info, index_t n, index_t i);
+};
+
+/*
+ `history_HC_ordering` visits the entries of every axis from the best to the
+ worst score in a `semimove_history`, so `take_point()` first tries the
+ semimoves that were accepted most often. Entries with equal features keep
+ the natural order, or a random one when a generator is supplied.
+
+ It also implements `observe()` (see ordering.h): the searches report every
+ point they examine, which trains the table for later orderings. The
+ ordering itself is fixed when it is constructed.
+
+     history_HC_ordering order(info, rng);
+     for(moveseq mvs : info.search(std::move(space), order)) { ... }
+ */
+class history_HC_ordering
+{
+    std::vector<std::vector<index_t>> orderings;
+    std::vector<std::vector<semimove_history::feature_t>> features;
+    std::vector<semimove_history::feature_t> present_features;
+    semimove_history *history;
+
+    void collect_features(const HC_info &info);
+    void sort_axes();
+public:
+    explicit history_HC_ordering(const HC_info &info,
+        semimove_history &history = semimove_history::local());
+    history_HC_ordering(const HC_info &info, std::mt19937 &rng,
+        semimove_history &history = semimove_history::local());
+
+    void for_each(index_t n, const integer_set& s, auto &&f) const
+    {
+        for(index_t i : orderings[n])
+        {
+            if(s.contains(i))
+            {
+                f(i);
+            }
+        }
+    }
+
+    semimove_history &table() const { return *history; }
+
+    /* a point without problem credits all of its entries; a rejected point
+     blames only the entries on the fixed axes of the problem slice */
+    void observe(const point &p, const std::optional<slice> &problem) const;
+};
+
+static_assert(HC_ordering<history_HC_ordering>);
+
+#endif /* HISTORY_ORDERING_H */
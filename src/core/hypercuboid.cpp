@@ -2,6 +2,7 @@
 #include "hypercuboid.h"
 
 #include <algorithm>
+#include <bit>
 #include <cassert>
 #include <iostream>
 #include <limits>
@@ -102,6 +103,60 @@ bool has_physical_check(const board &b, bool c)
     return false;
 }
 
+bool HC_info::gives_check(index_t n, index_t i) const
+{
+    const board *b = std::visit(overloads {
+        [](const physical_entry &e) { return e.b.get(); },
+        [](const arriving_entry &e) { return e.b.get(); },
+        [](const departing_entry &) -> board* { return nullptr; },
+        [](const null_entry &) -> board* { return nullptr; },
+    }, axis_coords.at(n).at(i));
+    if(b == nullptr)
+    {
+        return false;
+    }
+    // same as has_physical_check(*b, !c), without collecting the positions
+    const bool c = s.get_present().second;
+    for(bitboard_t royals = b->royal() & (c ? b->white() : b->black()); royals; royals &= royals - 1)
+    {
+        if(b->is_under_attack(std::countr_zero(royals), !c))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::size_t HC_info::memory_usage() const
+{
+    std::size_t result = sizeof(HC_info) + universe.memory_usage() - sizeof(HC)
+        + line_to_axis.size() * (sizeof(std::pair<const int, index_t>) + 4 * sizeof(void*))
+        + mandatory_lines.capacity() * sizeof(int);
+    for(const auto &coords : axis_coords)
+    {
+        result += sizeof(coords) + coords.capacity() * sizeof(entry);
+        for(const entry &e : coords)
+        {
+            if(!std::holds_alternative<null_entry>(e))
+            {
+                // the board and the control block of its shared_ptr
+                result += sizeof(board) + 2 * sizeof(void*);
+            }
+        }
+    }
+    return result;
+}
+
+piece_t HC_info::moved_piece(index_t n, index_t i) const
+{
+    return std::visit(overloads {
+        [](const physical_entry &e) { return e.b->get_piece(e.m.to.xy()); },
+        [](const arriving_entry &e) { return e.b->get_piece(e.m.to.xy()); },
+        [&](const departing_entry &e) { return s.get_piece(e.from, s.get_present().second); },
+        [](const null_entry &) { return NO_PIECE; },
+    }, axis_coords.at(n).at(i));
+}
+
 std::tuple<HC_info, search_space> HC_info::build_HC(const state& s)
 {
     dprint("HC_info::build_HC()");
@@ -381,11 +436,33 @@ std::optional<point> HC_info::take_point(HC &hc) const
 
 std::optional<slice> HC_info::find_problem(const point &p, const HC& hc) const
 {
-    std::optional<slice> problem = jump_order_consistent(p, hc).or_else([this, &hc, &p]() {
-        return test_present(p, hc).or_else([this, &hc, &p]() {
+    const auto run_layer = [](search_stats::layer l, auto check) {
+        std::optional<slice> problem;
+        {
+            search_stats::layer_timer timer(l);
+            problem = check();
+        }
+        if(problem)
+        {
+            search_stats::record_rejection(l, problem->get_fixed_axes().size());
+        }
+        return problem;
+    };
+    std::optional<slice> problem = run_layer(search_stats::JUMP_ORDER, [&]() {
+        return jump_order_consistent(p, hc);
+    });
+    if(!problem)
+    {
+        problem = run_layer(search_stats::PRESENT, [&]() {
+            return test_present(p, hc);
+        });
+    }
+    if(!problem)
+    {
+        problem = run_layer(search_stats::CHECKS, [&]() {
             return find_checks(p, hc);
         });
-    });
+    }
     return problem;
 }
 
@@ -941,7 +1018,7 @@ moveseq HC_info::to_action(const point &p) const
     std::vector<full_move> mvs;
     for(const auto &[l,i] : line_to_axis)
     {
-        entry loc = axis_coords[i][p[i]];
+        const entry &loc = axis_coords[i][p[i]];
         if(std::holds_alternative<physical_entry>(loc))
         {
             mvs.push_back(std::get<physical_entry>(loc).m);
@@ -1020,6 +1097,60 @@ generator<moveseq> HC_info::search(search_space ss) const
     return search(std::move(ss), natural_HC_ordering{});
 }
 
+void HC_info::absorb_problem(search_space &ss, const HC &hc, const slice &problem) const
+{
+    search_space adjoined;
+    adjoined.concat(hc.remove_slice(problem));
+    int intersect_count = 1;
+    int disjoint_count = 0;
+    while(!ss.empty() && disjoint_count * 10 < intersect_count)
+    {
+        HC &other_hc = ss.back();
+        if(other_hc.intersects(problem))
+        {
+            adjoined.concat(other_hc.remove_slice_if_good(problem, 1));
+            intersect_count++;
+        }
+        else
+        {
+            disjoint_count++;
+            adjoined.concat({{other_hc}});
+        }
+        ss.pop_back();
+    }
+    ss.concat(std::move(adjoined));
+}
+
+generator<moveseq> HC_info::resumable_search(search_space &ss, std::function<bool()> checkpoint) const
+{
+    while(!ss.empty())
+    {
+        if(checkpoint && !checkpoint())
+        {
+            co_return;
+        }
+        HC hc = ss.back();
+        ss.pop_back();
+        auto pt_opt = take_point(hc);
+        if(!pt_opt)
+        {
+            continue;
+        }
+
+        point pt = *pt_opt;
+        auto problem = find_problem(pt, hc);
+        if(!problem)
+        {
+            // the space must be up to date before the caller sees the action
+            moveseq mvs = to_action(pt);
+            ss.concat(hc.remove_point(pt));
+            co_yield mvs;
+            continue;
+        }
+        absorb_problem(ss, hc, *problem);
+    }
+}
+
 
 generator<moveseq> HC_info::mixed_search(search_space ss) const
 {
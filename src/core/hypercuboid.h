@@ -41,6 +41,8 @@
 
  To randomize the search order, construct a `random_HC_ordering` with the
  `universe` from `HC_info`, then pass it to `search()` or `iterative_search()`.
+ `lazy_random_HC_ordering` does the same without allocating, which suits
+ searches that only want the first few actions.
 
  Terminology and representation:
 
@@ -78,7 +80,11 @@
    the discovered problem so the search can remove all affected candidates.
  - `to_action()` reconstructs the complete `full_move` sequence from a valid
    point. It reads private entries, so no information is lost through the
-   semantic `semimove` projection.
+   semantic `semimove` projection. The moves are listed in the standard order
+   of `action`: moves on existing timelines by timeline, then the branching
+   moves in the order their timelines are created. Every action is found at
+   most once per search, so `canonical_hash()` (action.h) of the results
+   identifies them without building `action` objects.
 
  Search policies:
 
@@ -124,6 +130,10 @@ class HC_info
     static std::shared_ptr<board> extract_board(const entry &e);
     static std::pair<int, int> extract_tl(const entry &e);
     std::vector<std::vector<entry>> axis_coords;
+    /* absorb_problem(ss, hc, problem): the adaptive step of search(): remove
+     the problem from hc and from the dense run of intersecting hypercuboids
+     at the back of ss, then put the pieces back on ss */
+    void absorb_problem(search_space &ss, const HC &hc, const slice &problem) const;
 
 public:
     // local variables
@@ -132,6 +142,17 @@ public:
     HC_info(state s, std::map<int, index_t> lm, std::vector<std::vector<entry>> crds, HC uni, index_t ax, index_t dim, const std::vector<int> pl)
         : axis_coords(std::move(crds)), s(std::move(s)), line_to_axis(std::move(lm)), universe(std::move(uni)), new_axis(ax), dimension(dim), mandatory_lines(pl) {}
     semimove get_semimove(index_t n, index_t i) const;
+    /* gives_check(n, i): whether the board left by entry i of axis n has an
+     enemy royal piece under attack; departures and null entries never do */
+    bool gives_check(index_t n, index_t i) const;
+    /* moved_piece(n, i): the piece moved by entry i of axis n as it stands
+     after the move (the leaving piece for departures, NO_PIECE for null
+     entries) */
+    piece_t moved_piece(index_t n, index_t i) const;
+    /* memory_usage(): estimated bytes held by this object: the entry tables
+     with the boards they made, the universe and the state (counted without
+     the boards it shares with other states) */
+    std::size_t memory_usage() const;
 
     HC universe;
     const index_t new_axis, dimension; // axes 0, 1, ..., new_axis-1 are playable lines
@@ -172,6 +193,17 @@ public:
     generator<moveseq> iterative_search(search_space ss, Order order) const;
     generator<moveseq> stable_search(search_space ss) const;
     generator<moveseq> mixed_search(search_space ss) const;
+    /*
+     resumable_search(ss): search(ss) on a space owned by the caller. Whenever
+     it yields an action, `ss` holds exactly the candidates that were not
+     examined yet, so a copy of it (see search_space::write) can be handed
+     to a later resumable_search() to produce the remaining actions. The
+     actions come in the same order as from search().
+     `checkpoint`, if given, is called before each candidate is examined,
+     when `ss` is just as complete; the search ends once it returns false.
+     This lets the caller save or stop during a long run of rejections.
+     */
+    generator<moveseq> resumable_search(search_space &ss, std::function<bool()> checkpoint = {}) const;
     // /* uncomment when debugging */
     //std::vector<moveseq> search1(search_space ss) const;
 };
@@ -2,6 +2,7 @@
 #include <cassert>
 #include <limits>
 #include "graph.h"
+#include "search_stats.h"
 
 template<HC_ordering Order>
 std::optional<point> HC_info::take_point(HC &hc, const Order &order) const
@@ -63,6 +64,7 @@ std::optional<point> HC_info::take_point(HC &hc, const Order &order) const
         hc[n].minus(ghost_arrive_indices);
         if(hc[n].empty())
         {
+            search_stats::record_point(false);
             return std::nullopt;
         }
         if(!has_nonjump)
@@ -74,6 +76,7 @@ std::optional<point> HC_info::take_point(HC &hc, const Order &order) const
     auto matching = g.find_matching(must_include);
     if(!matching)
     {
+        search_stats::record_point(false);
         return std::nullopt;
     }
     for(const auto &[u, v] : *matching)
@@ -90,6 +93,7 @@ std::optional<point> HC_info::take_point(HC &hc, const Order &order) const
     }
 #endif
     assert(hc.contains(result));
+    search_stats::record_point(true);
     return result;
 }
 
@@ -108,6 +112,7 @@ generator<moveseq> HC_info::iterative_search(search_space ss, Order order) const
 
         point pt = *pt_opt;
         auto problem = find_problem(pt, hc);
+        observe_point(order, pt, problem);
         if(problem)
         {
             ss.concat(hc.remove_slice(*problem));
@@ -135,6 +140,7 @@ generator<moveseq> HC_info::search(search_space ss, Order order) const
 
         point pt = *pt_opt;
         auto problem = find_problem(pt, hc);
+        observe_point(order, pt, problem);
         if(!problem)
         {
             co_yield to_action(pt);
@@ -142,27 +148,7 @@ generator<moveseq> HC_info::search(search_space ss, Order order) const
             continue;
         }
 
-        const slice &problem_slice = *problem;
-        search_space adjoined;
-        adjoined.concat(hc.remove_slice(problem_slice));
-        int intersect_count = 1;
-        int disjoint_count = 0;
-        while(!ss.empty() && disjoint_count * 10 < intersect_count)
-        {
-            HC &other_hc = ss.back();
-            if(other_hc.intersects(problem_slice))
-            {
-                adjoined.concat(other_hc.remove_slice_if_good(problem_slice, 1));
-                intersect_count++;
-            }
-            else
-            {
-                disjoint_count++;
-                adjoined.concat({{other_hc}});
-            }
-            ss.pop_back();
-        }
-        ss.concat(std::move(adjoined));
+        absorb_problem(ss, hc, *problem);
     }
 }
 
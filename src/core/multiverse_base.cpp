@@ -67,6 +67,24 @@ multiverse::multiverse(std::vector<std::tuple<int, int, bool, std::string>> bds,
     }
 }
 
+std::uint64_t multiverse::hash() const
+{
+    std::uint64_t h = hash_mix(static_cast<std::uint64_t>(size_x) << 32 | static_cast<std::uint32_t>(size_y));
+    h = hash_mix(h ^ static_cast<std::uint32_t>(l_min));
+    for(std::size_t u = 0; u < boards.size(); u++)
+    {
+        for(std::size_t v = 0; v < boards[u].size(); v++)
+        {
+            if(boards[u][v])
+            {
+                h = hash_mix(h ^ (u << 32 | v));
+                h = hash_mix(h ^ boards[u][v]->hash());
+            }
+        }
+    }
+    return h;
+}
+
 turn_t multiverse::get_present() const
 {
     int present_v = std::numeric_limits<int>::max();
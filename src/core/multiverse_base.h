@@ -108,6 +108,9 @@ public:
             present_c is either false (for white) or true (for black)
      */
     turn_t get_present() const;
+    /* hash(): hash of every board with its coordinates and of the board
+     size; multiverses with equal boards hash equally */
+    std::uint64_t hash() const;
     
     // move generation
     template<bool C> bitboard_t gen_physical_moves(vec4 p) const;
@@ -602,51 +602,75 @@ mate_type state::get_mate_type_impl(bool legal_action_witness) const
 {
     dprint("state::get_mate_type()");
     auto [w, ss] = HC_info::build_HC(*this);
-    auto hc = ss.back();
-    search_space ss1 {{hc}};
+    search_space restricted {{ss.back()}};
     ss.pop_back();
-    // check if there is a non-branching move
-    if(w.search(ss1).first())
-    {
-        dprint("has non-branching action");
-        return mate_type::NONE;
-    }
-    search_space ss2 = ss;
     /* player can only create timeline_advantage+1 active lines */
     const auto [l0_min, l0_max] = get_initial_lines_range();
     const auto [l_min, l_max] = get_lines_range();
     int whites_lines = l_max - l0_max;
     int blacks_lines = l0_min - l_min;
     int timeline_advantage = player ? (whites_lines - blacks_lines) : (blacks_lines - whites_lines);
-    /* Build the search space `ss2` from `ss` so that
-    1. On new lines that are active, erase all moves traveling back in time
-    2. On other lines, do nothing */
-    for(HC &hc : ss2)
+    /* On new lines that are active, moves traveling back in time are
+    searched last. The entries are the same for every hc, so collect them
+    once per axis from the universe. */
+    const int max_axis = std::min(w.new_axis+timeline_advantage+1, w.dimension-1);
+    std::vector<integer_set> jump_back;
+    for(int n = w.new_axis; n <= max_axis; n++)
+    {
+        integer_set entries = w.universe[n];
+        entries.erase_if([&w, n, old_t=present](int i){
+            semimove sm = w.get_semimove(n, i);
+            if(sm.is<arriving_move>())
+            {
+                const auto &am = sm.get<arriving_move>();
+                int new_t = am.m.to.t();
+                return new_t >= old_t;
+            }
+            return true;
+        });
+        jump_back.push_back(std::move(entries));
+    }
+    /* Split the branching part `ss` into the points without these moves,
+    which join the non-branching hc in `restricted`, and the rest. Both are
+    searched at most once and the points of `restricted` are never
+    revisited. */
+    search_space rest;
+    for(HC &hc : ss)
     {
-        //NOTE: because most axes are the same, the following code can be optimized
-        int max_axis = std::min(w.new_axis+timeline_advantage+1, w.dimension-1);
+        HC r = hc;
+        slice allowed;
         for(int n = w.new_axis; n <= max_axis; n++)
         {
-            hc[n].erase_if([&w, n, old_t=present](int i){
-                semimove sm = w.get_semimove(n, i);
-                if(sm.is<arriving_move>())
-                {
-                    const auto &am = sm.get<arriving_move>();
-                    int new_t = am.m.to.t();
-                    return new_t < old_t;
-                }
-                return false;
-            });
+            const integer_set &removed = jump_back[n - w.new_axis];
+            if(r[n].intersects(removed))
+            {
+                r[n].minus(removed);
+                allowed.fix_axis(n, r[n]);
+            }
+        }
+        if(allowed.get_fixed_axes().empty())
+        {
+            restricted.push_back(std::move(hc));
+        }
+        else if(r.empty())
+        {
+            rest.push_back(std::move(hc));
+        }
+        else
+        {
+            rest.concat(hc.remove_slice(allowed));
+            restricted.push_back(std::move(r));
         }
     }
-    if(w.search(ss2).first())
+    if(w.search(std::move(restricted)).first())
     {
-        dprint("has branching non-jump back solution");
+        dprint("has non-branching or branching non-jump back solution");
         return mate_type::NONE;
     }
+    const bool opponent_attacked = phantom().find_checks(!player).first().has_value();
     if(legal_action_witness)
     {
-        if(phantom().find_checks(!player).first().has_value())
+        if(opponent_attacked)
         {
             dprint("softmate (legal action witnessed)");
             return mate_type::SOFTMATE;
@@ -654,9 +678,9 @@ mate_type state::get_mate_type_impl(bool legal_action_witness) const
         dprint("not softmate (legal action witnessed without check)");
         return mate_type::NONE;
     }
-    if(w.search(ss).first())
+    if(w.search(std::move(rest)).first())
     {
-        if(phantom().find_checks(!player).first().has_value())
+        if(opponent_attacked)
         {
             dprint("softmate");
             return mate_type::SOFTMATE;
@@ -669,7 +693,7 @@ mate_type state::get_mate_type_impl(bool legal_action_witness) const
     }
     else
     {
-        if(phantom().find_checks(!player).first().has_value())
+        if(opponent_attacked)
         {
             dprint("checkmate");
             return mate_type::CHECKMATE;
@@ -702,6 +726,11 @@ turn_t state::get_present() const
     return std::make_pair(present, player);
 }
 
+std::uint64_t state::hash() const
+{
+    return hash_mix(m->hash() ^ (static_cast<std::uint64_t>(static_cast<std::uint32_t>(present)) << 1 | player));
+}
+
 turn_t state::apparent_present() const
 {
     return m->get_present();
@@ -126,6 +126,8 @@ public:
     std::pair<int, int> get_board_size() const;
     turn_t get_present() const;
     turn_t apparent_present() const;
+    // hash of the multiverse and the player to move, see multiverse::hash()
+    std::uint64_t hash() const;
     std::pair<int, int> get_initial_lines_range() const;
     std::pair<int, int> get_lines_range() const;
     std::pair<int, int> get_active_range() const;
@@ -0,0 +1,396 @@
+#include "alphabeta.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <string_view>
+#include <utility>
+
+#include "hypercuboid.h"
+
+namespace
+{
+constexpr std::string_view hash_option = "Hash";
+// the clock is read once per this many generated actions
+constexpr std::size_t time_check_interval = 64;
+// bytes a table entry is counted as, besides its best action
+constexpr std::size_t tt_entry_overhead = 64;
+
+// mate scores are stored relative to the node, so that they stay valid at any ply
+alphabeta_engine::score_t to_table(alphabeta_engine::score_t score, int ply)
+{
+    if(score > alphabeta_engine::MATE_SCORE - alphabeta_max_depth)
+    {
+        return score + ply;
+    }
+    if(score < -alphabeta_engine::MATE_SCORE + alphabeta_max_depth)
+    {
+        return score - ply;
+    }
+    return score;
+}
+
+alphabeta_engine::score_t from_table(alphabeta_engine::score_t score, int ply)
+{
+    if(score > alphabeta_engine::MATE_SCORE - alphabeta_max_depth)
+    {
+        return score - ply;
+    }
+    if(score < -alphabeta_engine::MATE_SCORE + alphabeta_max_depth)
+    {
+        return score + ply;
+    }
+    return score;
+}
+
+state play(const state &position, const moveseq &moves)
+{
+    state next = position;
+    for(const full_move &move : moves)
+    {
+        next.apply_move(move);
+    }
+    next.submit();
+    return next;
+}
+
+std::uint64_t move_key(const full_move &move)
+{
+    return canonical_hash(moveseq{move});
+}
+
+// estimated bytes of a table entry holding `best`, including its heap storage
+std::size_t entry_bytes(const moveseq &best)
+{
+    return tt_entry_overhead + best.capacity() * sizeof(full_move);
+}
+} /* anonymous namespace */
+
+void alphabeta_engine::on_option_changed(const std::string &key, const option_value_t &value)
+{
+    if(key == hash_option)
+    {
+        if(const auto *mb = std::get_if<int>(&value); mb && *mb >= 0)
+        {
+            hash_mb.store(*mb);
+        }
+        return;
+    }
+    engine::on_option_changed(key, value);
+}
+
+void alphabeta_engine::start_new_game()
+{
+    table.clear();
+    table_bytes = 0;
+    history.clear();
+    engine::start_new_game();
+}
+
+bool alphabeta_engine::out_of_time()
+{
+    if(!aborted && (stop_token.stop_requested()
+                    || (deadline.has_value() && std::chrono::steady_clock::now() >= *deadline)))
+    {
+        aborted = true;
+    }
+    return aborted;
+}
+
+alphabeta_engine::score_t alphabeta_engine::evaluate(const state &position) const
+{
+    const float white_value = linear_engine::evaluate(position, weights);
+    const score_t score = static_cast<score_t>(std::lround(white_value * EVAL_SCALE));
+    return position.get_present().second ? -score : score;
+}
+
+std::vector<moveseq> alphabeta_engine::generate_actions(const state &position)
+{
+    auto [hc_info, search_space] = HC_info::build_HC(position);
+    std::vector<moveseq> actions;
+    // the search yields every action once
+    for(const moveseq &moves : hc_info.search(std::move(search_space)))
+    {
+        if(actions.size() % time_check_interval == 0 && out_of_time())
+        {
+            return {};
+        }
+        actions.push_back(moves);
+    }
+    return actions;
+}
+
+void alphabeta_engine::order_actions(std::vector<moveseq> &actions, const std::optional<moveseq> &tt_move, int ply)
+{
+    const std::optional<std::uint64_t> tt_key = tt_move.has_value()
+        ? std::optional<std::uint64_t>(canonical_hash(*tt_move))
+        : std::nullopt;
+    const std::array<std::uint64_t, 2> &ply_killers = killers[ply];
+    std::vector<std::pair<std::uint64_t, std::size_t>> keyed; // (priority, index)
+    keyed.reserve(actions.size());
+    for(std::size_t i = 0; i < actions.size(); i++)
+    {
+        const std::uint64_t key = canonical_hash(actions[i]);
+        std::uint64_t priority = 0;
+        if(key == tt_key)
+        {
+            priority = UINT64_MAX;
+        }
+        else if(key == ply_killers[0] || key == ply_killers[1])
+        {
+            priority = UINT64_MAX - (key == ply_killers[0] ? 1 : 2);
+        }
+        else
+        {
+            for(const full_move &move : actions[i])
+            {
+                if(const auto it = history.find(move_key(move)); it != history.end())
+                {
+                    priority += it->second;
+                }
+            }
+            priority = std::min(priority, UINT64_MAX - 3);
+        }
+        keyed.emplace_back(priority, i);
+    }
+    std::stable_sort(keyed.begin(), keyed.end(), [](const auto &a, const auto &b) {
+        return a.first > b.first;
+    });
+    std::vector<moveseq> ordered;
+    ordered.reserve(actions.size());
+    for(const auto &[priority, index] : keyed)
+    {
+        ordered.push_back(std::move(actions[index]));
+    }
+    actions = std::move(ordered);
+}
+
+void alphabeta_engine::record_cutoff(const moveseq &moves, int depth, int ply)
+{
+    const std::uint64_t key = canonical_hash(moves);
+    std::array<std::uint64_t, 2> &ply_killers = killers[ply];
+    if(ply_killers[0] != key)
+    {
+        ply_killers[1] = ply_killers[0];
+        ply_killers[0] = key;
+    }
+    for(const full_move &move : moves)
+    {
+        history[move_key(move)] += static_cast<std::uint64_t>(depth) * static_cast<std::uint64_t>(depth);
+    }
+}
+
+void alphabeta_engine::store(std::uint64_t key, int depth, score_t score, bound_t bound, int ply, moveseq best)
+{
+    const std::size_t budget = static_cast<std::size_t>(std::max(0, hash_mb.load())) << 20;
+    // a full table starts over rather than keeping entries of earlier searches
+    if(budget != 0 && table_bytes + entry_bytes(best) > budget)
+    {
+        table.clear();
+        table_bytes = 0;
+    }
+    const auto [it, inserted] = table.try_emplace(key);
+    tt_entry &entry = it->second;
+    if(entry.best.empty() || depth >= entry.depth)
+    {
+        if(!inserted)
+        {
+            table_bytes -= entry_bytes(entry.best);
+        }
+        entry = {depth, to_table(score, ply), bound, std::move(best)};
+        table_bytes += entry_bytes(entry.best);
+    }
+}
+
+alphabeta_engine::score_t alphabeta_engine::search(const state &position, int depth, score_t alpha, score_t beta, int ply)
+{
+    if(out_of_time())
+    {
+        return 0;
+    }
+    ++nodes;
+    if(depth == 0)
+    {
+        return evaluate(position);
+    }
+    const std::uint64_t key = position.hash();
+    std::optional<moveseq> tt_move;
+    if(const auto it = table.find(key); it != table.end())
+    {
+        ++tt_hits;
+        const tt_entry &entry = it->second;
+        tt_move = entry.best;
+        if(entry.depth >= depth && ply > 0)
+        {
+            const score_t score = from_table(entry.score, ply);
+            if(entry.bound == bound_t::EXACT
+               || (entry.bound == bound_t::LOWER && score >= beta)
+               || (entry.bound == bound_t::UPPER && score <= alpha))
+            {
+                return score;
+            }
+        }
+    }
+    std::vector<moveseq> actions = generate_actions(position);
+    if(aborted)
+    {
+        return 0;
+    }
+    if(actions.empty())
+    {
+        return position.get_mate_type() == mate_type::STALEMATE ? 0 : -MATE_SCORE + ply;
+    }
+    if(killers.size() <= static_cast<std::size_t>(ply))
+    {
+        killers.resize(ply + 1, {0, 0});
+    }
+    order_actions(actions, tt_move, ply);
+    const score_t original_alpha = alpha;
+    score_t best_score = -INFINITE_SCORE;
+    std::size_t best_index = 0;
+    for(std::size_t i = 0; i < actions.size(); i++)
+    {
+        const state next = play(position, actions[i]);
+        score_t score;
+        if(i == 0)
+        {
+            score = -search(next, depth - 1, -beta, -alpha, ply + 1);
+        }
+        else
+        {
+            score = -search(next, depth - 1, -alpha - 1, -alpha, ply + 1);
+            if(score > alpha && score < beta)
+            {
+                score = -search(next, depth - 1, -beta, -alpha, ply + 1);
+            }
+        }
+        if(aborted)
+        {
+            return 0;
+        }
+        if(score > best_score)
+        {
+            best_score = score;
+            best_index = i;
+        }
+        alpha = std::max(alpha, score);
+        if(alpha >= beta)
+        {
+            record_cutoff(actions[i], depth, ply);
+            break;
+        }
+    }
+    const bound_t bound = best_score <= original_alpha ? bound_t::UPPER
+        : best_score >= beta ? bound_t::LOWER
+        : bound_t::EXACT;
+    if(ply == 0)
+    {
+        root_best = actions[best_index];
+    }
+    store(key, depth, best_score, bound, ply, std::move(actions[best_index]));
+    return best_score;
+}
+
+std::vector<moveseq> alphabeta_engine::principal_variation(state position, int depth) const
+{
+    std::vector<moveseq> pv;
+    while(static_cast<int>(pv.size()) < depth)
+    {
+        const auto it = table.find(position.hash());
+        if(it == table.end() || it->second.best.empty())
+        {
+            break;
+        }
+        pv.push_back(it->second.best);
+        position = play(position, pv.back());
+    }
+    return pv;
+}
+
+std::optional<action> alphabeta_engine::find_best_move(std::optional<int> depth_limit, std::optional<int> time_limit_ms, std::stop_token stop)
+{
+    const auto search_started = std::chrono::steady_clock::now();
+    const state root = get_current_state().value();
+    stop_token = stop;
+    deadline.reset();
+    if(time_limit_ms.has_value())
+    {
+        deadline = search_started + std::chrono::milliseconds(*time_limit_ms);
+    }
+    aborted = false;
+    nodes = 0;
+    tt_hits = 0;
+    root_best.reset();
+    killers.clear();
+    const int max_depth = std::clamp(depth_limit.value_or(alphabeta_max_depth), 1, alphabeta_max_depth);
+    std::optional<moveseq> best;
+    int completed_depth = 0;
+    score_t best_score = 0;
+    for(int depth = 1; depth <= max_depth; depth++)
+    {
+        const score_t score = search(root, depth, -INFINITE_SCORE, INFINITE_SCORE, 0);
+        if(aborted)
+        {
+            break;
+        }
+        if(!root_best.has_value())
+        {
+            break; // no legal action
+        }
+        best = root_best;
+        completed_depth = depth;
+        best_score = score;
+        const double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - search_started).count();
+        std::ostringstream info;
+        info << std::setprecision(9)
+             << "alphabeta depth=" << depth
+             << " score=" << score
+             << " nodes=" << nodes
+             << " nps=" << (seconds > 0.0 ? static_cast<double>(nodes) / seconds : 0.0)
+             << " elapsed_seconds=" << seconds
+             << " pv";
+        state s = root;
+        const std::vector<moveseq> pv = principal_variation(root, depth);
+        for(std::size_t i = 0; i < pv.size(); i++)
+        {
+            const action act = action::from_moveseq(pv[i], s);
+            info << (i == 0 ? " " : " / ") << act.pgn(s);
+            s = play(s, pv[i]);
+        }
+        send_info(info.str());
+        // a forced mate is not improved by searching deeper
+        if(std::abs(score) > MATE_SCORE - alphabeta_max_depth)
+        {
+            break;
+        }
+    }
+    const double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - search_started).count();
+    const double nodes_per_second = seconds > 0.0 ? static_cast<double>(nodes) / seconds : 0.0;
+    record_search_speed(nodes_per_second);
+    std::ostringstream stats;
+    stats << std::setprecision(17)
+          << "alphabeta_stats elapsed_seconds=" << seconds
+          << " depth=" << completed_depth
+          << " score=" << best_score
+          << " nodes=" << nodes
+          << " nps=" << nodes_per_second
+          << " tt_hits=" << tt_hits
+          << " tt_entries=" << table.size();
+    send_info(stats.str());
+    if(!best.has_value())
+    {
+        // out of time before depth 1 was complete: any legal action
+        auto [hc_info, search_space] = HC_info::build_HC(root);
+        std::optional<moveseq> first = hc_info.search(std::move(search_space)).first();
+        if(!first.has_value())
+        {
+            return std::nullopt;
+        }
+        best = std::move(first);
+    }
+    return action::from_moveseq(*best, root);
+}
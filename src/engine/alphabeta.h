@@ -0,0 +1,103 @@
+#ifndef ALPHABETA_H
+#define ALPHABETA_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stop_token>
+#include <unordered_map>
+#include <vector>
+
+#include "uci.h"
+#include "linear.h"
+
+// memory budget of the transposition table in MB ("Hash" option)
+constexpr int default_alphabeta_hash_mb = 64;
+// deepest iteration of a search without a depth limit
+constexpr int alphabeta_max_depth = 64;
+
+/*
+ Alpha-beta engine: a deterministic negamax search over the actions streamed
+ by HC_info::search(), with the linear evaluation (see linear_engine) at its
+ horizon.
+
+ The search deepens iteratively until its depth limit, deadline or stop,
+ and plays the best action of the deepest completed iteration. Every node
+ searches its first action with the full window and the others with a null
+ window, searching again with the full window when one of them beats alpha.
+ Actions are tried in the order: best action from the transposition table,
+ the two killer actions of the ply, then by the history of their moves.
+
+ Scores are integers from the view of the player to move: the evaluation
+ scaled to +-EVAL_SCALE, or MATE_SCORE less the number of actions to mate.
+ */
+class alphabeta_engine : public engine
+{
+public:
+    using score_t = int;
+    static constexpr score_t EVAL_SCALE = 10'000;
+    static constexpr score_t MATE_SCORE = 1'000'000;
+    static constexpr score_t INFINITE_SCORE = MATE_SCORE + 1;
+
+private:
+    enum class bound_t : std::uint8_t
+    {
+        EXACT,
+        LOWER, // the score is at least this
+        UPPER  // the score is at most this
+    };
+    struct tt_entry
+    {
+        int depth;
+        score_t score;
+        bound_t bound;
+        moveseq best;
+    };
+
+    linear_engine::weight_vector_t weights;
+    std::atomic<int> hash_mb{default_alphabeta_hash_mb};
+    // kept between searches, cleared on a new game
+    std::unordered_map<std::uint64_t, tt_entry> table;
+    std::size_t table_bytes = 0; // estimated, with the heap storage of each best action
+    // the canonical hashes of the last two actions causing a cutoff, by ply
+    std::vector<std::array<std::uint64_t, 2>> killers;
+    // by the canonical hash of a single move: how much it caused cutoffs
+    std::unordered_map<std::uint64_t, std::uint64_t> history;
+
+    // state of the running search
+    std::stop_token stop_token;
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    bool aborted = false;
+    std::size_t nodes = 0;
+    std::size_t tt_hits = 0;
+    std::optional<moveseq> root_best;
+
+    bool out_of_time();
+    score_t evaluate(const state &position) const;
+    // the distinct actions of `position`, empty if there are none or the search ran out of time
+    std::vector<moveseq> generate_actions(const state &position);
+    void order_actions(std::vector<moveseq> &actions, const std::optional<moveseq> &tt_move, int ply);
+    void record_cutoff(const moveseq &moves, int depth, int ply);
+    void store(std::uint64_t key, int depth, score_t score, bound_t bound, int ply, moveseq best);
+    score_t search(const state &position, int depth, score_t alpha, score_t beta, int ply);
+    // the best actions from `position` recorded in the table, at most `depth` of them
+    std::vector<moveseq> principal_variation(state position, int depth) const;
+
+protected:
+    void on_option_changed(const std::string &key, const option_value_t &value) override;
+
+public:
+    alphabeta_engine(
+        std::unique_ptr<io_handler> io_handler,
+        linear_engine::weight_vector_t weights = linear_engine::default_weights())
+    : engine(std::move(io_handler)),
+      weights(std::move(weights)) {}
+    void initialize() override {}
+    void start_new_game() override;
+    std::optional<action> find_best_move(std::optional<int> depth_limit, std::optional<int> time_limit_ms, std::stop_token stop_token) override;
+};
+
+#endif /* ALPHABETA_H */
@@ -1,7 +1,10 @@
 #include "flat_ucb.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <limits>
+#include <mutex>
 #include <random>
 #include <iomanip>
 #include <sstream>
@@ -9,6 +12,7 @@
 
 #include "hypercuboid.h"
 #include "rollout.h"
+#include "time_control.h"
 #include "uct.h"
 
 namespace
@@ -16,13 +20,17 @@ namespace
 constexpr int depth_to_iteration_multiplier = 10;
 constexpr float winning_score = 1.0f;
 constexpr std::string_view rollout_max_actions_option = "rollout-max-actions";
+constexpr std::string_view threads_option = "Threads";
+// a clock-managed search checks this often whether its choice is decided
+constexpr std::size_t decided_check_interval = 16;
 
+// the statistics are guarded by the search lock
 struct flat_child
 {
     moveseq moves;
-    state position;
     float sum_reward = 0.0f;
     std::size_t visits = 0;
+    std::size_t pending = 0; // rollouts still running
 };
 } /* anonymous namespace */
 
@@ -36,6 +44,14 @@ void flat_ucb_engine::on_option_changed(const std::string &key, const option_val
         }
         return;
     }
+    if(key == threads_option)
+    {
+        if(const auto *count = std::get_if<int>(&value); count && *count >= 1)
+        {
+            threads.store(*count);
+        }
+        return;
+    }
     engine::on_option_changed(key, value);
 }
 
@@ -48,15 +64,10 @@ std::optional<action> flat_ucb_engine::find_best_move(
     const state &root = get_current_state().value();
     auto [hypercuboid, search_state] = HC_info::build_HC(root);
     std::vector<flat_child> children;
+    // the search yields every action once
     for(const moveseq &moves : hypercuboid.search(search_state))
     {
-        state position = root;
-        for(const full_move &move : moves)
-        {
-            position.apply_move(move);
-        }
-        position.submit();
-        children.push_back({moves, std::move(position)});
+        children.push_back({moves});
     }
     if(children.empty())
     {
@@ -76,50 +87,121 @@ std::optional<action> flat_ucb_engine::find_best_move(
             + std::chrono::milliseconds(*time_limit_ms);
     }
 
-    std::optional<std::mt19937> rollout_rng;
-    if(rollout_seed.has_value())
+    const std::size_t worker_count = static_cast<std::size_t>(std::max(1, threads.load()));
+    if(workers == nullptr || workers->size() != worker_count - 1)
     {
-        rollout_rng.emplace(*rollout_seed);
+        workers = std::make_unique<thread_pool>(worker_count - 1);
     }
     const bool maximizing_player = !root.get_present().second;
-    std::size_t total_visits = 0;
-    while(!stop_token.stop_requested()
-          && (!iteration_limit.has_value() || total_visits < *iteration_limit)
-          && (!deadline.has_value() || std::chrono::steady_clock::now() < *deadline))
+    const bool stop_when_decided = is_clock_managed() && deadline.has_value();
+    // every pending rollout counts as a visit lost by the player to move
+    const float pending_reward = maximizing_player ? -winning_score : winning_score;
+    const auto loop_started = std::chrono::steady_clock::now();
+    std::mutex search_mutex;
+    std::size_t total_visits = 0; // guarded by search_mutex, like the fields below
+    std::size_t started_visits = 0;
+    std::size_t total_pending = 0;
+    bool finished = false;
+    std::optional<std::chrono::steady_clock::time_point> first_rollout;
+    workers->run(worker_count, [&](std::size_t worker)
     {
-        std::size_t selected = 0;
-        float best_score = maximizing_player
-            ? -std::numeric_limits<float>::infinity()
-            : std::numeric_limits<float>::infinity();
-        for(std::size_t i = 0; i < children.size(); ++i)
+        std::optional<std::mt19937> rollout_rng;
+        if(rollout_seed.has_value())
         {
-            const flat_child &child = children[i];
-            const float score = uct(child.sum_reward, child.visits, total_visits, maximizing_player);
-            if((maximizing_player && score > best_score)
-               || (!maximizing_player && score < best_score))
-            {
-                selected = i;
-                best_score = score;
-            }
-        }
-        const std::optional<bool> winner = rollout(
-            children[selected].position,
-            rollout_max_actions.load(),
-            stop_token,
-            rollout_rng.has_value() ? &*rollout_rng : nullptr);
-        if(stop_token.stop_requested())
-        {
-            break;
+            rollout_rng.emplace(*rollout_seed + static_cast<std::uint32_t>(worker));
         }
-        if(winner.has_value())
+        while(!stop_token.stop_requested())
         {
-            children[selected].sum_reward += *winner
-                ? -winning_score
-                : winning_score;
+            std::size_t selected = 0;
+            {
+                std::lock_guard<std::mutex> lock(search_mutex);
+                if(finished
+                   || (iteration_limit.has_value() && started_visits >= *iteration_limit)
+                   || (deadline.has_value() && std::chrono::steady_clock::now() >= *deadline))
+                {
+                    break;
+                }
+                if(stop_when_decided && total_visits > 0 && total_visits % decided_check_interval == 0)
+                {
+                    // stop once no other child can reach the most visits in the time left
+                    const auto now = std::chrono::steady_clock::now();
+                    const double remaining = static_cast<double>(total_visits)
+                        * std::chrono::duration<double>(*deadline - now).count()
+                        / std::chrono::duration<double>(now - loop_started).count();
+                    std::size_t best_visits = 0;
+                    std::size_t second_visits = 0;
+                    for(const flat_child &child : children)
+                    {
+                        if(child.visits > best_visits)
+                        {
+                            second_visits = best_visits;
+                            best_visits = child.visits;
+                        }
+                        else
+                        {
+                            second_visits = std::max(second_visits, child.visits);
+                        }
+                    }
+                    if(selection_decided(best_visits, second_visits, remaining))
+                    {
+                        finished = true;
+                        break;
+                    }
+                }
+                float best_score = maximizing_player
+                    ? -std::numeric_limits<float>::infinity()
+                    : std::numeric_limits<float>::infinity();
+                for(std::size_t i = 0; i < children.size(); ++i)
+                {
+                    const flat_child &child = children[i];
+                    const float score = uct(
+                        child.sum_reward + pending_reward * static_cast<float>(child.pending),
+                        child.visits + child.pending,
+                        total_visits + total_pending,
+                        maximizing_player);
+                    if((maximizing_player && score > best_score)
+                       || (!maximizing_player && score < best_score))
+                    {
+                        selected = i;
+                        best_score = score;
+                    }
+                }
+                ++children[selected].pending;
+                ++total_pending;
+                ++started_visits;
+            }
+            state position = root;
+            for(const full_move &move : children[selected].moves)
+            {
+                position.apply_move(move);
+            }
+            position.submit();
+            const std::optional<bool> winner = rollout_inplace(
+                position,
+                rollout_max_actions.load(),
+                stop_token,
+                rollout_rng.has_value() ? &*rollout_rng : nullptr);
+            std::lock_guard<std::mutex> lock(search_mutex);
+            --children[selected].pending;
+            --total_pending;
+            if(stop_token.stop_requested())
+            {
+                break;
+            }
+            if(winner.has_value())
+            {
+                children[selected].sum_reward += *winner
+                    ? -winning_score
+                    : winning_score;
+            }
+            ++children[selected].visits;
+            ++total_visits;
+            if(!first_rollout.has_value())
+            {
+                first_rollout = std::chrono::steady_clock::now();
+            }
         }
-        ++children[selected].visits;
-        ++total_visits;
-    }
+    });
 
     const flat_child *best = &children.front();
     for(const flat_child &child : children)
@@ -134,12 +216,25 @@ std::optional<action> flat_ucb_engine::find_best_move(
         : 0.0f;
     const double elapsed_seconds = std::chrono::duration<double>(
         std::chrono::steady_clock::now() - search_started).count();
+    // the arms hold nothing but their moves
+    std::size_t child_bytes = children.capacity() * sizeof(flat_child);
+    for(const flat_child &child : children)
+    {
+        child_bytes += child.moves.capacity() * sizeof(full_move);
+    }
+    record_search_speed(elapsed_seconds > 0.0
+        ? static_cast<double>(total_visits) / elapsed_seconds : 0.0);
     std::ostringstream stats_info;
     stats_info << std::setprecision(17)
                << "flat_uct_stats elapsed_seconds=" << elapsed_seconds
                << " iterations=" << total_visits
                << " ips=" << (elapsed_seconds > 0.0
-                   ? static_cast<double>(total_visits) / elapsed_seconds : 0.0);
+                   ? static_cast<double>(total_visits) / elapsed_seconds : 0.0)
+               << " threads=" << worker_count
+               << " children=" << children.size()
+               << " child_bytes=" << child_bytes
+               << " first_rollout_seconds=" << (first_rollout.has_value()
+                   ? std::chrono::duration<double>(*first_rollout - search_started).count() : elapsed_seconds);
     send_info(stats_info.str());
     std::ostringstream score_info;
     score_info << std::setprecision(9) << "flat_uct_score score=" << selected_score;
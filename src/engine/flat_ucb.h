@@ -4,18 +4,31 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <stop_token>
 #include <vector>
 
 #include "uci.h"
+#include "thread_pool.h"
 
 constexpr int default_flat_ucb_rollout_max_actions = 200;
 
+/*
+ Flat UCT: every legal root action is an arm, played out by random rollouts
+ and chosen among by the adversarial UCT rule. An arm keeps only its moves;
+ each visit plays them on the worker's own copy of the root. With `Threads`
+ workers, each selects under a shared lock, counting the rollouts still
+ running as lost, and rolls out with its own generator (seed + k for worker
+ k) on a thread pool kept between searches.
+ */
 class flat_ucb_engine : public engine
 {
     std::optional<std::uint32_t> rollout_seed;
     std::atomic<int> rollout_max_actions;
+    // number of search workers ("Threads" option)
+    std::atomic<int> threads{1};
+    std::unique_ptr<thread_pool> workers;
 
 protected:
     void on_option_changed(const std::string &key, const option_value_t &value) override;
@@ -4,12 +4,13 @@
 #include <array>
 #include <cmath>
 #include <numeric>
+#include <string_view>
 #include <utility>
 
-#include "rollout.h"
-
 namespace
 {
+constexpr std::string_view EVAL_INTERVAL_OPTION = "eval-interval";
+constexpr std::string_view EVAL_CUTOFF_OPTION = "eval-cutoff";
 
 template<timelines_status Status>
 void append_material_features(
@@ -130,41 +131,143 @@ linear_engine::feature_vector_t linear_engine::extract_features(
 }
 
 float linear_engine::evaluate(const state &position) const
+{
+    return evaluate(position, weight_vector);
+}
+
+float linear_engine::evaluate(const state &position, const weight_vector_t &weights)
 {
     const feature_vector_t features = extract_features(position);
     const float linear_score = std::inner_product(
         features.begin(),
         features.end(),
-        weight_vector.begin(),
+        weights.begin(),
         0.0f);
     const float player_score = WINNING_SCORE * std::tanh(linear_score);
     return position.get_present().second ? -player_score : player_score;
 }
 
+namespace
+{
+/* settle_decided(): the rollout plays its next action only after a segment,
+ so a segment can end on a mated or stalemated position; this records such
+ a result as the end of the rollout and returns true */
+bool settle_decided(const state &position, rollout_result &played)
+{
+    const mate_type mate = position.get_mate_type();
+    if(mate == mate_type::NONE)
+    {
+        return false;
+    }
+    const auto [present, player] = position.get_present();
+    (void)present;
+    played.termination = mate == mate_type::CHECKMATE
+        ? rollout_termination::WINNER
+        : rollout_termination::STALEMATE;
+    played.winner = mate == mate_type::CHECKMATE ? std::optional<bool>{!player} : std::nullopt;
+    return true;
+}
+} /* anonymous namespace */
+
+linear_rollout_result linear_engine::evaluated_rollout(
+    state &position,
+    int max_actions,
+    const linear_cutoff_options &cutoff,
+    const weight_vector_t &weights,
+    std::stop_token stop_token,
+    std::mt19937 *rng,
+    rollout_sampler sampler)
+{
+    const int step = cutoff.interval > 0 ? cutoff.interval : max_actions;
+    rollout_result played{rollout_termination::ACTION_LIMIT, std::nullopt, 0, {}};
+    std::size_t evaluations = 0;
+    int remaining = max_actions;
+    while(true)
+    {
+        // each segment continues the rollout with the same generator
+        rollout_result segment = rollout_inplace_detailed(
+            position,
+            std::min(step, remaining),
+            stop_token,
+            rng,
+            sampler);
+        if(played.actions == 0)
+        {
+            played.first_action = std::move(segment.first_action);
+        }
+        played.actions += segment.actions;
+        played.termination = segment.termination;
+        played.winner = segment.winner;
+        remaining -= std::min(step, remaining);
+        if(segment.termination != rollout_termination::ACTION_LIMIT || remaining == 0
+           || settle_decided(position, played))
+        {
+            break;
+        }
+        const float score = evaluate(position, weights);
+        ++evaluations;
+        if(std::abs(score) >= cutoff.threshold * WINNING_SCORE)
+        {
+            return {score, std::move(played), true, evaluations};
+        }
+    }
+    float score = 0.0f;
+    /* without cutoffs the rollout ends like before, on an evaluation of its
+     final position, and pays for no mate check */
+    if(played.termination == rollout_termination::ACTION_LIMIT
+       && !(cutoff.interval > 0 && settle_decided(position, played)))
+    {
+        score = evaluate(position, weights);
+        ++evaluations;
+    }
+    else if(played.winner.has_value())
+    {
+        score = *played.winner ? -WINNING_SCORE : WINNING_SCORE;
+    }
+    return {score, std::move(played), false, evaluations};
+}
+
+void linear_engine::on_option_changed(const std::string &key, const option_value_t &value)
+{
+    if(key == EVAL_INTERVAL_OPTION)
+    {
+        if(const auto *interval = std::get_if<int>(&value); interval && *interval >= 0)
+        {
+            eval_interval.store(*interval);
+        }
+        return;
+    }
+    if(key == EVAL_CUTOFF_OPTION)
+    {
+        // "setoption" reads whole numbers as integers
+        const double *number = std::get_if<double>(&value);
+        const int *whole = std::get_if<int>(&value);
+        const double threshold = number ? *number : whole ? *whole : -1.0;
+        if(threshold >= 0.0)
+        {
+            eval_cutoff.store(static_cast<float>(threshold));
+        }
+        return;
+    }
+    mcts_engine::on_option_changed(key, value);
+}
+
 default_policy_result linear_engine::default_policy(
     state position,
     std::stop_token stop_token,
     std::mt19937 *rng)
 {
-    const rollout_result result = rollout_inplace_detailed(
+    linear_rollout_result result = evaluated_rollout(
         position,
         rollout_max_actions.load(),
+        {eval_interval.load(), eval_cutoff.load()},
+        weight_vector,
         stop_token,
-        rng);
+        rng,
+        history_ordering.load() ? rollout_sampler::HISTORY_SEARCH : rollout_sampler::ORDERED_SEARCH);
     if(stop_token.stop_requested())
     {
         return {0.0f, rollout_termination::STOPPED};
     }
-    if(result.winner.has_value())
-    {
-        return {
-            *result.winner ? -WINNING_SCORE : WINNING_SCORE,
-            result.termination
-        };
-    }
-    if(result.termination == rollout_termination::STALEMATE)
-    {
-        return {0.0f, result.termination};
-    }
-    return {evaluate(position), result.termination};
+    return {result.score, result.rollout.termination, std::move(result.rollout.first_action)};
 }
@@ -2,17 +2,46 @@
 #define LINEAR_H
 
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <optional>
 #include <random>
 #include <stop_token>
+#include <string>
 #include <utility>
 
 #include "mcts.h"
+#include "rollout.h"
 #include "statistics.h"
 
+// "eval-interval": actions between the evaluations of a rollout, 0 evaluates only its final position
+constexpr int default_linear_eval_interval = 0;
+// "eval-cutoff": a rollout ends at an evaluation reaching this share of WINNING_SCORE
+constexpr float default_linear_eval_cutoff = 0.9f;
+
+/*
+ Evaluation cutoffs of a rollout. Every `interval` actions the rollout
+ position is evaluated, and the rollout ends with that value once its
+ magnitude reaches `threshold` * WINNING_SCORE. A threshold of 0 ends every
+ rollout at its first evaluation: a fixed-length rollout of `interval`
+ actions.
+ */
+struct linear_cutoff_options
+{
+    int interval = default_linear_eval_interval;
+    float threshold = default_linear_eval_cutoff;
+};
+
+struct linear_rollout_result
+{
+    float score;           // from White's side
+    rollout_result rollout; // ACTION_LIMIT also when cut off
+    bool cut_off;          // ended early by an evaluation
+    std::size_t evaluations;
+};
+
 class linear_engine : public mcts_engine
 {
 public:
@@ -54,8 +83,11 @@ public:
 
 private:
     weight_vector_t weight_vector{};
+    std::atomic<int> eval_interval{default_linear_eval_interval};
+    std::atomic<float> eval_cutoff{default_linear_eval_cutoff};
 
 protected:
+    void on_option_changed(const std::string &key, const option_value_t &value) override;
     default_policy_result default_policy(
         state position,
         std::stop_token stop_token,
@@ -75,6 +107,18 @@ public:
 
     static feature_vector_t extract_features(const state &position);
     float evaluate(const state &position) const;
+    // the value of `position` for White under `weights`, in (-WINNING_SCORE, WINNING_SCORE)
+    static float evaluate(const state &position, const weight_vector_t &weights);
+    // plays a rollout from `position` in place and scores it: a decided game
+    // by its result, an undecided one by the evaluation it ended on
+    static linear_rollout_result evaluated_rollout(
+        state &position,
+        int max_actions,
+        const linear_cutoff_options &cutoff,
+        const weight_vector_t &weights,
+        std::stop_token stop_token = {},
+        std::mt19937 *rng = nullptr,
+        rollout_sampler sampler = rollout_sampler::ORDERED_SEARCH);
 
     const weight_vector_t &get_weights() const
     {
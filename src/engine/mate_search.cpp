@@ -0,0 +1,284 @@
+#include "mate_search.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+
+#include "hypercuboid.h"
+#include "utils.h"
+
+namespace
+{
+constexpr std::uint32_t PN_INFINITY = UINT32_MAX / 2;
+// bytes a table entry is counted as, with the overhead of its hash node
+constexpr std::size_t TABLE_ENTRY_BYTES = 64;
+// the clock is read once per this many generated actions
+constexpr std::size_t TIME_CHECK_INTERVAL = 64;
+
+struct proof_numbers
+{
+    std::uint32_t pn = 1;
+    std::uint32_t dn = 1;
+};
+
+constexpr proof_numbers PROVEN{0, PN_INFINITY};
+constexpr proof_numbers DISPROVEN{PN_INFINITY, 0};
+
+std::uint32_t saturating_add(std::uint32_t a, std::uint32_t b)
+{
+    return std::min(PN_INFINITY, a + b);
+}
+
+state play(const state &position, const moveseq &moves)
+{
+    state next = position;
+    for(const full_move &move : moves)
+    {
+        next.apply_move(move);
+    }
+    next.submit();
+    return next;
+}
+
+/*
+ A node is a position with the attacker or the defender to move and the
+ number of actions the attacker has left. An attacker node is proven by one
+ proven child (pn is the least child pn, dn the sum of child dns); a
+ defender node by all its children (pn is the sum, dn the least).
+ */
+class mate_solver
+{
+    const mate_search_options &options;
+    std::unordered_map<std::uint64_t, proof_numbers> table;
+    std::size_t max_entries;
+public:
+    std::size_t nodes = 0;
+    std::size_t clears = 0;
+    bool stopped = false;
+
+    explicit mate_solver(const mate_search_options &options)
+    : options(options),
+      max_entries(std::max<std::size_t>(1, options.memory_budget / TABLE_ENTRY_BYTES)) {}
+
+    std::size_t table_entries() const
+    {
+        return table.size();
+    }
+
+    static std::uint64_t key(const state &position, int remaining, bool attacker)
+    {
+        return hash_mix(position.hash() ^ hash_mix(static_cast<std::uint64_t>(remaining) * 2 + attacker));
+    }
+
+    // the numbers of a node not searched yet; the defender's last position is decided at once
+    proof_numbers initial(const state &position, int remaining, bool attacker) const
+    {
+        if(!attacker && remaining == 0)
+        {
+            return position.get_mate_type() == mate_type::CHECKMATE ? PROVEN : DISPROVEN;
+        }
+        const auto it = table.find(key(position, remaining, attacker));
+        return it != table.end() ? it->second : proof_numbers{};
+    }
+
+    void store(const state &position, int remaining, bool attacker, proof_numbers numbers)
+    {
+        if(table.size() >= max_entries)
+        {
+            table.clear();
+            clears++;
+        }
+        table[key(position, remaining, attacker)] = numbers;
+    }
+
+    bool out_of_time()
+    {
+        if(!stopped && (options.stop_token.stop_requested()
+                        || (options.deadline.has_value() && std::chrono::steady_clock::now() >= *options.deadline)))
+        {
+            stopped = true;
+        }
+        return stopped;
+    }
+
+    // the distinct actions of `position`, incomplete once the search is stopped
+    std::vector<moveseq> generate_actions(const state &position)
+    {
+        auto [hc_info, search_space] = HC_info::build_HC(position);
+        std::vector<moveseq> actions;
+        for(const moveseq &moves : hc_info.search(std::move(search_space)))
+        {
+            if(actions.size() % TIME_CHECK_INTERVAL == 0 && out_of_time())
+            {
+                break;
+            }
+            actions.push_back(moves);
+        }
+        return actions;
+    }
+
+    // searches below the node until its pn reaches `pn_threshold` or its dn `dn_threshold`
+    proof_numbers search(const state &position, int remaining, bool attacker,
+                         std::uint32_t pn_threshold, std::uint32_t dn_threshold)
+    {
+        ++nodes;
+        struct child_node
+        {
+            state position;
+            proof_numbers numbers;
+        };
+        std::vector<child_node> children;
+        const std::vector<moveseq> actions = generate_actions(position);
+        if(stopped)
+        {
+            // some actions may be missing, so nothing can be concluded
+            return proof_numbers{};
+        }
+        for(const moveseq &moves : actions)
+        {
+            state next = play(position, moves);
+            const proof_numbers numbers = initial(next, attacker ? remaining - 1 : remaining, !attacker);
+            // one mating action, or one surviving reply, settles the node
+            if(attacker ? numbers.pn == 0 : numbers.dn == 0)
+            {
+                const proof_numbers settled = attacker ? PROVEN : DISPROVEN;
+                store(position, remaining, attacker, settled);
+                return settled;
+            }
+            children.push_back({std::move(next), numbers});
+        }
+        if(children.empty())
+        {
+            // checkmated or stalemated: only a mated defender is a win
+            const proof_numbers settled = !attacker && position.get_mate_type() == mate_type::CHECKMATE
+                ? PROVEN : DISPROVEN;
+            store(position, remaining, attacker, settled);
+            return settled;
+        }
+        proof_numbers numbers;
+        while(true)
+        {
+            // attacker: pn = min, dn = sum; defender: pn = sum, dn = min
+            std::uint32_t min_value = PN_INFINITY;
+            std::uint32_t second_value = PN_INFINITY;
+            std::uint32_t sum_value = 0;
+            std::size_t best = 0;
+            for(std::size_t i = 0; i < children.size(); i++)
+            {
+                const proof_numbers &child = children[i].numbers;
+                const std::uint32_t chosen = attacker ? child.pn : child.dn;
+                const std::uint32_t summed = attacker ? child.dn : child.pn;
+                if(chosen < min_value)
+                {
+                    second_value = min_value;
+                    min_value = chosen;
+                    best = i;
+                }
+                else
+                {
+                    second_value = std::min(second_value, chosen);
+                }
+                sum_value = saturating_add(sum_value, summed);
+            }
+            numbers = attacker ? proof_numbers{min_value, sum_value} : proof_numbers{sum_value, min_value};
+            if(numbers.pn >= pn_threshold || numbers.dn >= dn_threshold || out_of_time())
+            {
+                break;
+            }
+            child_node &child = children[best];
+            std::uint32_t child_pn_threshold;
+            std::uint32_t child_dn_threshold;
+            if(attacker)
+            {
+                child_pn_threshold = std::min(pn_threshold, saturating_add(second_value, 1));
+                child_dn_threshold = saturating_add(dn_threshold - numbers.dn, child.numbers.dn);
+            }
+            else
+            {
+                child_dn_threshold = std::min(dn_threshold, saturating_add(second_value, 1));
+                child_pn_threshold = saturating_add(pn_threshold - numbers.pn, child.numbers.pn);
+            }
+            child.numbers = search(child.position, attacker ? remaining - 1 : remaining, !attacker,
+                                   child_pn_threshold, child_dn_threshold);
+        }
+        if(!stopped)
+        {
+            store(position, remaining, attacker, numbers);
+        }
+        return numbers;
+    }
+
+    // follows proven children from a proven root, proving again what a cleared table forgot
+    std::vector<moveseq> mating_line(state position, int remaining)
+    {
+        std::vector<moveseq> line;
+        bool attacker = true;
+        // the defender is mated once the attacker has no action left
+        while(remaining > 0)
+        {
+            const int next_remaining = attacker ? remaining - 1 : remaining;
+            std::vector<std::pair<moveseq, state>> children;
+            for(const moveseq &moves : generate_actions(position))
+            {
+                children.emplace_back(moves, play(position, moves));
+            }
+            if(stopped)
+            {
+                break;
+            }
+            // every reply of a proven defender is proven, so its first one will do
+            auto proven = attacker ? children.end() : children.begin();
+            if(attacker)
+            {
+                proven = std::find_if(children.begin(), children.end(), [&](const auto &child) {
+                    return initial(child.second, next_remaining, false).pn == 0;
+                });
+                for(auto it = children.begin(); proven == children.end() && it != children.end() && !out_of_time(); ++it)
+                {
+                    if(search(it->second, next_remaining, false, PN_INFINITY, PN_INFINITY).pn == 0)
+                    {
+                        proven = it;
+                    }
+                }
+            }
+            if(proven == children.end())
+            {
+                break;
+            }
+            line.push_back(std::move(proven->first));
+            position = std::move(proven->second);
+            remaining = next_remaining;
+            attacker = !attacker;
+        }
+        return line;
+    }
+};
+} /* anonymous namespace */
+
+mate_search_result find_mate(const state &position, int max_actions, const mate_search_options &options)
+{
+    mate_solver solver(options);
+    mate_search_result result{mate_search_status::UNKNOWN, {}, 0, 0, 0};
+    if(max_actions > 0)
+    {
+        const proof_numbers root = solver.search(position, max_actions, true, PN_INFINITY, PN_INFINITY);
+        if(!solver.stopped && root.pn == 0)
+        {
+            result.status = mate_search_status::MATE;
+            result.line = solver.mating_line(position, max_actions);
+        }
+        else if(!solver.stopped && root.dn == 0)
+        {
+            result.status = mate_search_status::NO_MATE;
+        }
+    }
+    else
+    {
+        result.status = mate_search_status::NO_MATE;
+    }
+    result.nodes = solver.nodes;
+    result.table_entries = solver.table_entries();
+    result.table_clears = solver.clears;
+    return result;
+}
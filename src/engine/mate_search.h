@@ -0,0 +1,59 @@
+#ifndef MATE_SEARCH_H
+#define MATE_SEARCH_H
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <stop_token>
+#include <vector>
+
+#include "state.h"
+
+// bytes the proof table of a mate search may hold by default
+constexpr std::size_t default_mate_search_memory = std::size_t{64} << 20;
+
+/*
+ Mate-in-N solver: a depth-first proof-number search (df-pn) for a forced
+ checkmate by the player to move within N of their own actions.
+
+ The player to move (the attacker) needs one action that mates whatever the
+ defender replies; the defender refutes with one reply that survives. Each
+ node carries a proof number (how many leaves still have to be proven for a
+ mate) and a disproof number, and the search always expands the most proving
+ node below the root until the root is proven or disproven. Actions come
+ from HC_info::search(); after the attacker's last action the defender must
+ be checkmated by state::get_mate_type().
+
+ The proof and disproof numbers of searched nodes are kept in a table keyed
+ by position and remaining actions, so transposed lines are searched once.
+ When the table outgrows `memory_budget`, it is cleared and the search
+ continues from the numbers held on the stack.
+ */
+struct mate_search_options
+{
+    std::size_t memory_budget = default_mate_search_memory;
+    std::stop_token stop_token;
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+};
+
+enum class mate_search_status
+{
+    MATE,    // forced mate within the given actions
+    NO_MATE, // the defender survives every line
+    UNKNOWN  // stopped before the question was settled
+};
+
+struct mate_search_result
+{
+    mate_search_status status;
+    // with MATE: the attacker's actions and the defender's replies of one
+    // mating line, cut short only by a stop or the deadline
+    std::vector<moveseq> line;
+    std::size_t nodes;
+    std::size_t table_entries;
+    std::size_t table_clears;
+};
+
+mate_search_result find_mate(const state &position, int max_actions, const mate_search_options &options = {});
+
+#endif /* MATE_SEARCH_H */
@@ -1,15 +1,22 @@
 #include "mcts.h"
 #include "rollout.h"
+#include <algorithm>
 #include <limits>
 #include <cmath>
+#include <cstdint>
 #include <chrono>
 #include <iomanip>
 #include <stop_token>
 #include <random>
 #include <sstream>
 #include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include "hypercuboid.h"
 #include "scope.h"
+#include "search_stats.h"
+#include "time_control.h"
 #include "utils.h"
 
 //#define DEBUGMSG
@@ -17,13 +24,169 @@
 
 constexpr int DEPTH_TO_ITERATION_MULTIPLIER = 10; // if depth limit is set, iteration_limit = depth_limit * DEPTH_TO_ITERATION_MULTIPLIER
 constexpr std::string_view ROLLOUT_MAX_ACTIONS_OPTION = "rollout-max-actions";
+constexpr std::string_view HISTORY_ORDERING_OPTION = "history-ordering";
+constexpr std::string_view THREADS_OPTION = "Threads";
+constexpr std::string_view HASH_OPTION = "Hash";
+constexpr std::string_view WIDENING_K_OPTION = "widening-k";
+constexpr std::string_view WIDENING_ALPHA_OPTION = "widening-alpha";
+constexpr std::string_view WIDENING_ORDER_OPTION = "widening-order";
+constexpr std::string_view RAVE_EQUIVALENCE_OPTION = "rave-equivalence";
+constexpr std::string_view INFO_INTERVAL_OPTION = "info-interval";
+constexpr std::string_view ROLLOUTS_PER_LEAF_OPTION = "RolloutsPerLeaf";
+// with RAVE, how many new children the search finds before one enters the tree
+constexpr std::size_t AMAF_CANDIDATES = 4;
+// a clock-managed search checks this often whether its best line is decided
+constexpr std::size_t DECIDED_CHECK_INTERVAL = 16;
+// the clock is read for the next progress report this often
+constexpr std::size_t PROGRESS_CHECK_INTERVAL = 16;
 
 namespace
 {
 
 using node_t = fine_node<mcts_node_info>;
 
-node_t *expand(node_t *node, std::stop_token stop_token)
+// "setoption" reads whole numbers as integers
+std::optional<double> number_option(const engine::option_value_t &value)
+{
+    if(const auto *number = std::get_if<double>(&value))
+    {
+        return *number;
+    }
+    if(const auto *number = std::get_if<int>(&value))
+    {
+        return *number;
+    }
+    return std::nullopt;
+}
+
+std::uint64_t square_bits(vec4 v)
+{
+    return static_cast<std::uint64_t>(static_cast<std::uint16_t>(v.l())) << 32
+        | static_cast<std::uint64_t>(static_cast<std::uint16_t>(v.t())) << 16
+        | static_cast<std::uint64_t>(v.y()) << 8
+        | static_cast<std::uint64_t>(v.x());
+}
+
+std::uint64_t amaf_key(std::uint64_t kind, vec4 hotspot, vec4 target)
+{
+    return hash_mix(hash_mix(kind ^ square_bits(hotspot) << 2) ^ square_bits(target));
+}
+
+// the AMAF key of a semimove: its kind, hotspot and target; none for a null move
+std::optional<std::uint64_t> amaf_key(const semimove &sm)
+{
+    return sm.visit(overloads{
+        [](const physical_move &mv) -> std::optional<std::uint64_t> { return amaf_key(0, mv.m.from, mv.m.to); },
+        [](const arriving_move &mv) -> std::optional<std::uint64_t> { return amaf_key(1, mv.m.to, mv.m.from); },
+        [](const departing_move &mv) -> std::optional<std::uint64_t> { return amaf_key(2, mv.from, mv.from); },
+        [](const null_move &) -> std::optional<std::uint64_t> { return std::nullopt; }
+    });
+}
+
+// the AMAF keys of the semimoves making up `mv`, see HC_info
+void append_amaf_keys(const full_move &mv, std::vector<std::uint64_t> &keys)
+{
+    if(mv.from.l() == mv.to.l() && mv.from.t() == mv.to.t())
+    {
+        keys.push_back(amaf_key(0, mv.from, mv.to));
+    }
+    else
+    {
+        keys.push_back(amaf_key(2, mv.from, mv.from));
+        keys.push_back(amaf_key(1, mv.to, mv.from));
+    }
+}
+
+// the semimove that `child` plays in the position of its parent
+semimove semimove_of(const node_t *child)
+{
+    return child->get_parent()->get_context()->hc_info.get_semimove(child->get_n(), child->get_i());
+}
+
+/* amaf_source(): the table entry holding the AMAF statistics of the
+ semimoves played below `node`, that of its nearest nodal ancestor; null
+ without RAVE */
+const mcts_transposition *amaf_source(node_t *node, double rave_equivalence)
+{
+    if(rave_equivalence <= 0.0)
+    {
+        return nullptr;
+    }
+    while(!node->is_nodal())
+    {
+        node = node->get_parent();
+    }
+    return node->get_info().transposition;
+}
+
+// the AMAF statistics of the semimove `child` plays, null if it has none
+const mcts_amaf_stats *amaf_stats_of(const mcts_transposition *source, const node_t *child)
+{
+    if(source == nullptr)
+    {
+        return nullptr;
+    }
+    const std::optional<std::uint64_t> key = amaf_key(semimove_of(child));
+    const auto amaf = key.has_value() ? source->amaf.find(*key) : source->amaf.end();
+    return amaf != source->amaf.end() && amaf->second.visits > 0 ? &amaf->second : nullptr;
+}
+
+/* next_unincluded(): the child of `node` to take into the tree next, among
+ those found but not included. Without AMAF statistics, the first one; with
+ them, the one whose semimove has the best AMAF average for the player
+ choosing, counting a semimove without statistics as a draw. */
+node_t *next_unincluded(node_t *node, const mcts_transposition *amaf)
+{
+    const bool max_player = !node->get_player(); // white=max, black=min
+    node_t *chosen = nullptr;
+    double chosen_value = 0.0;
+    for(node_t *child : node->get_children())
+    {
+        if(child->get_info().is_included)
+        {
+            continue;
+        }
+        if(amaf == nullptr)
+        {
+            return child;
+        }
+        const mcts_amaf_stats *stats = amaf_stats_of(amaf, child);
+        const double value = stats != nullptr
+            ? stats->sum_reward / static_cast<double>(stats->visits)
+            : 0.0;
+        if(chosen == nullptr || (max_player ? value > chosen_value : value < chosen_value))
+        {
+            chosen = child;
+            chosen_value = value;
+        }
+    }
+    return chosen;
+}
+
+/* widening_allows(): true if `node` may take one more child into the tree.
+ A node whose children in the tree are all solved may always widen. */
+bool widening_allows(node_t *node, const mcts_widening &widening)
+{
+    if(widening.k <= 0.0)
+    {
+        return true;
+    }
+    std::size_t included = 0;
+    bool all_solved = true;
+    for(node_t *child : node->get_children())
+    {
+        if(child->get_info().is_included)
+        {
+            included++;
+            all_solved = all_solved && child->get_info().proven_outcome.has_value();
+        }
+    }
+    const double visits = static_cast<double>(node->get_info().visits.load(std::memory_order_relaxed));
+    const double allowed = std::max(1.0, widening.k * std::pow(visits, widening.alpha));
+    return all_solved || static_cast<double>(included) < allowed;
+}
+
+node_t *expand(node_t *node, std::stop_token stop_token, const mcts_widening &widening, double rave_equivalence)
 {
     dprint("expand", node->print_semimove(), (node->is_nodal() ? "nodal" : "temporary"), (node->is_ceiling() ? "ceiling" : ""),
            "fully_expanded=", node->get_info().fully_expanded,
@@ -34,19 +197,20 @@ node_t *expand(node_t *node, std::stop_token stop_token)
         dprint("expand: fully_expanded, returning nullptr");
         return nullptr;
     }
+    if(!widening_allows(node, widening))
+    {
+        dprint("expand: widening limit reached, returning nullptr");
+        return nullptr;
+    }
     // mark unexpanded children as included if possible
     if(!node->get_info().all_children_included)
     {
-        for(node_t *child : node->get_children())
+        if(node_t *child = next_unincluded(node, amaf_source(node, rave_equivalence)))
         {
-            dprint("expand: checking child", child->print_semimove(), "included=", child->get_info().is_included, "visits=", child->get_info().visits);
-            if(!child->get_info().is_included)
-            {
-                child->set_info(mcts_node_info{});
-                child->get_info().is_included = true;
-                dprint("expand: returning existing unincluded child", child->print_semimove(), "visits=", child->get_info().visits);
-                return child;
-            }
+            child->set_info(mcts_node_info{});
+            child->get_info().is_included = true;
+            dprint("expand: returning existing unincluded child", child->print_semimove());
+            return child;
         }
         node->get_info().all_children_included = true;
         dprint("expand: all children already included, falling through");
@@ -64,7 +228,33 @@ node_t *expand(node_t *node, std::stop_token stop_token)
     }
     // search out another branch
     dprint("expand: calling search()");
-    if(auto i_opt = node->search().first())
+    // an ignited ceiling plays from its own position
+    const mcts_transposition *amaf = amaf_source(node, rave_equivalence);
+    if(amaf != nullptr && !amaf->amaf.empty())
+    {
+        // the next few children found compete for the place by their AMAF averages
+        std::size_t found = 0;
+        for(index_t i : node->search())
+        {
+            (void)i;
+            if(++found == AMAF_CANDIDATES)
+            {
+                break;
+            }
+        }
+        if(found > 0)
+        {
+            node_t *child = next_unincluded(node, amaf);
+            assert(child != nullptr);
+            // the others wait among the children not included yet
+            node->get_info().all_children_included = false;
+            child->set_info(mcts_node_info{});
+            child->get_info().is_included = true;
+            dprint("expand: RAVE chose child", child->print_semimove(), "among", found);
+            return child;
+        }
+    }
+    else if(auto i_opt = node->search().first())
     {
         node_t *child = node->get_child(*i_opt);
         assert(child != nullptr);
@@ -78,23 +268,53 @@ node_t *expand(node_t *node, std::stop_token stop_token)
     return nullptr;
 }
 
-node_t *best_child(node_t *node)
+/* best_child(): the child to descend to by the UCT rule. With a positive
+ `rave_equivalence` k, the average reward of a child is blended with the AMAF
+ average of its semimove, weighted by sqrt(k / (3N + k)) for N visits. */
+node_t *best_child(node_t *node, double rave_equivalence)
 {
-    dprint("best_child()", node->print_semimove(), "visits=", node->get_info().visits);
+    dprint("best_child()", node->print_semimove(), "visits=", node->get_info().visits.load());
     node_t *best_child = nullptr;
     bool max_player = !node->get_player(); // white=max, black=min
     float best_val = max_player ? -std::numeric_limits<float>::infinity() : std::numeric_limits<float>::infinity();
+    // every pending rollout counts as a visit lost by the player choosing the child
+    const float pending_reward = max_player ? -WINNING_SCORE : WINNING_SCORE;
+    const std::size_t parent_visits = node->get_info().visits.load(std::memory_order_relaxed)
+        + node->get_info().virtual_loss.load(std::memory_order_relaxed);
+    const mcts_transposition *amaf = amaf_source(node, rave_equivalence);
     for(node_t *child : node->get_children())
     {
         const auto &info = child->get_info();
-        if(info.visits == 0)
+        const std::uint32_t pending = info.virtual_loss.load(std::memory_order_relaxed);
+        std::size_t visits = info.visits.load(std::memory_order_relaxed);
+        float sum_reward = info.sum_reward.load(std::memory_order_relaxed);
+        // a solved subtree has nothing left to learn
+        if((visits == 0 && pending == 0) || info.proven_outcome.has_value())
         {
             continue;
         }
+        // a transposed position is valued with the playouts of every line reaching it
+        if(info.transposition != nullptr)
+        {
+            const std::size_t shared_visits = info.transposition->visits.load(std::memory_order_relaxed);
+            if(shared_visits > visits)
+            {
+                visits = shared_visits;
+                sum_reward = info.transposition->sum_reward.load(std::memory_order_relaxed);
+            }
+        }
+        const mcts_amaf_stats *stats = visits > 0 ? amaf_stats_of(amaf, child) : nullptr;
+        if(stats != nullptr)
+        {
+            const double beta = std::sqrt(rave_equivalence / (3.0 * static_cast<double>(visits) + rave_equivalence));
+            const double own_average = sum_reward / static_cast<double>(visits);
+            const double amaf_average = stats->sum_reward / static_cast<double>(stats->visits);
+            sum_reward = static_cast<float>(((1.0 - beta) * own_average + beta * amaf_average) * static_cast<double>(visits));
+        }
         float uct_score = uct(
-            info.sum_reward,
-            info.visits,
-            node->get_info().visits,
+            sum_reward + pending_reward * static_cast<float>(pending),
+            visits + pending,
+            parent_visits,
             max_player);
         bool better = max_player ? (uct_score > best_val) : (uct_score < best_val);
         if(better)
@@ -113,18 +333,18 @@ node_t *best_child(node_t *node)
 }
 
 
-node_t *tree_policy(node_t *node, std::stop_token stop_token)
+node_t *tree_policy(node_t *node, std::stop_token stop_token, const mcts_search_limits &limits)
 {
     dprint("tree_policy()", node->print_semimove(), (node->is_nodal() ? "nodal" : "temporary"), (node->is_ceiling() ? "ceiling" : ""));
     while(!node->is_terminal() && !stop_token.stop_requested())
     {
-        node_t *next_node = expand(node, stop_token);
+        node_t *next_node = expand(node, stop_token, limits.widening, limits.rave_equivalence);
         if(next_node)
         {
             return next_node;
         }
         // if no unexpanded children, select the best child
-        node_t *bc = best_child(node);
+        node_t *bc = best_child(node, limits.rave_equivalence);
         if(bc == nullptr)
         {
             // no valid children found, return current node
@@ -135,55 +355,583 @@ node_t *tree_policy(node_t *node, std::stop_token stop_token)
     return node;
 }
 
-state rollout_state(node_t *node)
+state rollout_state(node_t *node)
+{
+    if(node->is_terminal())
+    {
+        return node->get_context()->hc_info.s;
+    }
+    node_t *ceiling_node = node->get_nearby_ceiling();
+    assert(ceiling_node != nullptr && "rollout node should have a nearby ceiling node");
+    if(!ceiling_node->is_nodal())
+    {
+        ceiling_node->ignite();
+    }
+    return ceiling_node->get_context()->hc_info.s;
+}
+
+void add_virtual_loss(node_t *node)
+{
+    for(; node != nullptr; node = node->get_parent())
+    {
+        node->get_info().virtual_loss.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void remove_virtual_loss(node_t *node)
+{
+    for(; node != nullptr; node = node->get_parent())
+    {
+        node->get_info().virtual_loss.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+/* solve(): the outcome of `node` proven by its children, if any. The player
+ choosing among them wins if one child is a proven win; otherwise the node is
+ proven only once all its children are known and proven. */
+std::optional<float> solve(node_t *node)
+{
+    const bool max_player = !node->get_player(); // white=max, black=min
+    const float win = max_player ? WINNING_SCORE : -WINNING_SCORE;
+    bool all_proven = node->get_info().fully_expanded;
+    std::optional<float> best;
+    for(node_t *child : node->get_children())
+    {
+        const auto &info = child->get_info();
+        if(!info.is_included || !info.proven_outcome.has_value())
+        {
+            all_proven = false;
+            continue;
+        }
+        if(*info.proven_outcome == win)
+        {
+            return win;
+        }
+        if(!best.has_value() || (max_player ? *info.proven_outcome > *best : *info.proven_outcome < *best))
+        {
+            best = info.proven_outcome;
+        }
+    }
+    return all_proven ? best : std::nullopt;
+}
+
+/* prove(): records the outcome of the solved `node`, then solves its
+ ancestors as far as that outcome decides them */
+void prove(node_t *node, float outcome, mcts_counters &counters)
+{
+    node->get_info().proven_outcome = outcome;
+    ++counters.proven_nodes;
+    for(node = node->get_parent(); node != nullptr && !node->get_info().proven_outcome.has_value(); node = node->get_parent())
+    {
+        const std::optional<float> solved = solve(node);
+        if(!solved.has_value())
+        {
+            break;
+        }
+        node->get_info().proven_outcome = solved;
+        ++counters.proven_nodes;
+    }
+}
+
+// every hash node of the table or of an AMAF map holds its value and a link; every bucket a pointer
+constexpr std::size_t TABLE_LINK_BYTES = sizeof(void*);
+constexpr std::size_t TABLE_ENTRY_BYTES = sizeof(mcts_transposition_table::value_type) + TABLE_LINK_BYTES;
+constexpr std::size_t AMAF_ENTRY_BYTES = sizeof(std::pair<const std::uint64_t, mcts_amaf_stats>) + TABLE_LINK_BYTES;
+
+/* table_entry(): the entry of `key`, made if needed; adds what a new entry
+ costs to `bytes` */
+mcts_transposition &table_entry(mcts_transposition_table &table, std::uint64_t key, std::size_t &bytes)
+{
+    const std::size_t buckets = table.bucket_count();
+    const auto [it, inserted] = table.try_emplace(key);
+    if(inserted)
+    {
+        bytes += TABLE_ENTRY_BYTES + it->second.amaf.bucket_count() * TABLE_LINK_BYTES
+            + (table.bucket_count() - buckets) * TABLE_LINK_BYTES;
+    }
+    return it->second;
+}
+
+/* attach_transpositions(): looks up the position of every nodal node on the
+ path to `node` that has no table entry yet, adding new entries to `bytes`.
+ A hit is an entry that another node of the tree uses already. */
+void attach_transpositions(node_t *node, mcts_transposition_table &table, std::size_t &bytes, mcts_counters &counters)
+{
+    for(; node != nullptr; node = node->get_parent())
+    {
+        auto &info = node->get_info();
+        if(info.transposition != nullptr || !node->is_nodal())
+        {
+            continue;
+        }
+        mcts_transposition &entry = table_entry(table, node->get_context()->hc_info.s.hash(), bytes);
+        info.transposition = &entry;
+        ++counters.transposition_lookups;
+        if(entry.claims > 0)
+        {
+            ++counters.transposition_hits;
+        }
+        entry.claims++;
+    }
+}
+
+void credit_amaf(mcts_transposition &entry, const std::vector<std::uint64_t> &keys, float outcome, std::size_t &bytes)
+{
+    for(std::uint64_t key : keys)
+    {
+        const std::size_t buckets = entry.amaf.bucket_count();
+        const auto [it, inserted] = entry.amaf.try_emplace(key);
+        if(inserted)
+        {
+            bytes += AMAF_ENTRY_BYTES + (entry.amaf.bucket_count() - buckets) * TABLE_LINK_BYTES;
+        }
+        mcts_amaf_stats &stats = it->second;
+        stats.sum_reward += outcome;
+        stats.visits++;
+    }
+}
+
+/* record_amaf(): credits `outcome` to every semimove of this playout in the
+ position it was played from: the semimoves on the path to `leaf`, and those
+ of the rollout's first action from the position `rollout_position`. New
+ entries are added to `bytes`. */
+void record_amaf(
+    node_t *leaf,
+    std::optional<std::uint64_t> rollout_position,
+    const moveseq &first_action,
+    float outcome,
+    mcts_transposition_table &table,
+    std::size_t &bytes)
+{
+    std::vector<std::uint64_t> keys;
+    for(node_t *node = leaf; node->get_parent() != nullptr; node = node->get_parent())
+    {
+        node_t *parent = node->get_parent();
+        if(const std::optional<std::uint64_t> key = amaf_key(semimove_of(node)))
+        {
+            keys.push_back(*key);
+        }
+        if(parent->is_nodal())
+        {
+            if(parent->get_info().transposition != nullptr)
+            {
+                credit_amaf(*parent->get_info().transposition, keys, outcome, bytes);
+            }
+            keys.clear();
+        }
+    }
+    if(rollout_position.has_value() && !first_action.empty())
+    {
+        for(const full_move &mv : first_action)
+        {
+            append_amaf_keys(mv, keys);
+        }
+        credit_amaf(table_entry(table, *rollout_position, bytes), keys, outcome, bytes);
+    }
+}
+
+/* backpropagate(): records `weight` playouts with the average `outcome` and
+ takes back the virtual loss of this iteration. Each edge of the path is updated, and so is the shared entry of
+ each ceiling on it; a path never reaches the same position twice, since every
+ action adds boards, so no entry is counted twice per playout. */
+void backpropagate(node_t *node, float outcome, std::size_t weight)
+{
+    const float reward = outcome * static_cast<float>(weight);
+    while(node != nullptr)
+    {
+        auto &info = node->get_info();
+        info.sum_reward.fetch_add(reward, std::memory_order_relaxed);
+        info.visits.fetch_add(weight, std::memory_order_relaxed);
+        info.virtual_loss.fetch_sub(1, std::memory_order_relaxed);
+        if(info.transposition != nullptr)
+        {
+            info.transposition->sum_reward.fetch_add(reward, std::memory_order_relaxed);
+            info.transposition->visits.fetch_add(weight, std::memory_order_relaxed);
+        }
+        node = node->get_parent();
+    }
+}
+
+/* most_visited_child(): the child to play from `node`. Proven wins for the
+ player choosing come first and proven losses last; visits decide otherwise. */
+node_t *most_visited_child(node_t *node)
+{
+    const float win = node->get_player() ? -WINNING_SCORE : WINNING_SCORE;
+    const auto proof_rank = [win](node_t *child)
+    {
+        const std::optional<float> &outcome = child->get_info().proven_outcome;
+        return !outcome.has_value() ? 1 : *outcome == win ? 2 : *outcome == -win ? 0 : 1;
+    };
+    node_t *best = nullptr;
+    for(node_t *child : node->get_children())
+    {
+        if(child->get_info().visits == 0)
+        {
+            continue;
+        }
+        if(best == nullptr
+           || proof_rank(child) > proof_rank(best)
+           || (proof_rank(child) == proof_rank(best)
+               && child->get_info().visits > best->get_info().visits))
+        {
+            best = child;
+        }
+    }
+    return best;
+}
+
+/* true if no visit count along the most visited line can be overtaken by
+ `remaining` more iterations, so the action find_best_move() picks is fixed */
+bool line_decided(node_t *node, double remaining)
+{
+    while(!node->is_ceiling())
+    {
+        std::size_t best = 0;
+        std::size_t second = 0;
+        node_t *best_child = nullptr;
+        for(node_t *child : node->get_children())
+        {
+            const std::size_t visits = child->get_info().visits.load(std::memory_order_relaxed);
+            if(best_child == nullptr || visits > best)
+            {
+                second = best;
+                best = visits;
+                best_child = child;
+            }
+            else
+            {
+                second = std::max(second, visits);
+            }
+        }
+        if(best_child == nullptr || !selection_decided(best, second, remaining))
+        {
+            return false;
+        }
+        node = best_child;
+    }
+    return true;
+}
+
+// iterations the search can still run at its speed so far
+double remaining_iterations(const mcts_search_limits &limits, const mcts_counters &counters)
+{
+    const auto now = std::chrono::steady_clock::now();
+    const double elapsed = std::chrono::duration<double>(now - limits.started).count();
+    const double left = std::chrono::duration<double>(*limits.deadline - now).count();
+    const std::size_t done = counters.iterations.load(std::memory_order_relaxed);
+    double remaining = done > 0 && elapsed > 0.0
+        ? static_cast<double>(done) / elapsed * std::max(0.0, left)
+        : std::numeric_limits<double>::infinity();
+    if(limits.iterations.has_value())
+    {
+        remaining = std::min(remaining, static_cast<double>(*limits.iterations) - static_cast<double>(done));
+    }
+    return remaining;
+}
+
+struct tree_size
+{
+    std::size_t bytes = 0;
+    std::size_t nodal_nodes = 0;
+    std::size_t table_entries = 0;
+};
+
+// estimated bytes of the transposition table, with the AMAF maps of its entries
+std::size_t table_memory_usage(const mcts_transposition_table &table)
+{
+    std::size_t bytes = table.bucket_count() * TABLE_LINK_BYTES;
+    for(const auto &[key, entry] : table)
+    {
+        bytes += TABLE_ENTRY_BYTES + entry.amaf.bucket_count() * TABLE_LINK_BYTES
+            + entry.amaf.size() * AMAF_ENTRY_BYTES;
+    }
+    return bytes;
+}
+
+// adds the transposition table to `size`
+void measure_table(const mcts_transposition_table &table, tree_size &size)
+{
+    size.bytes += table_memory_usage(table);
+    size.table_entries += table.size();
+}
+
+/* evict_unclaimed(): drops the table entries no node points to: the
+ positions of released subtrees and of rollouts that started outside the
+ tree. Returns how many were dropped. */
+std::size_t evict_unclaimed(mcts_transposition_table &table)
+{
+    return std::erase_if(table, [](const auto &item) { return item.second.claims == 0; });
+}
+
+/* unclaim_below(): gives back the table entries of the nodes below the
+ ignited ceiling `node`, which extinguish() is about to free */
+void unclaim_below(node_t *node)
+{
+    for(node_t &below : node->get_context()->node_pool)
+    {
+        if(below.get_info().transposition != nullptr)
+        {
+            below.get_info().transposition->claims--;
+        }
+        if(below.is_nodal() && &below != node)
+        {
+            unclaim_below(&below);
+        }
+    }
+}
+
+/* reclaim_transpositions(): recounts the claims on the table from the nodes
+ of `root`'s tree, after the nodes above a reused root were freed */
+void reclaim_transpositions(node_t *root, mcts_transposition_table &table)
+{
+    for(auto &[key, entry] : table)
+    {
+        entry.claims = 0;
+    }
+    const auto claim = [](node_t *node, const auto &self) -> void
+    {
+        for(node_t &below : node->get_context()->node_pool)
+        {
+            if(below.get_info().transposition != nullptr)
+            {
+                below.get_info().transposition->claims++;
+            }
+            if(below.is_nodal())
+            {
+                self(&below, self);
+            }
+        }
+    };
+    if(root->get_info().transposition != nullptr)
+    {
+        root->get_info().transposition->claims++;
+    }
+    claim(root, claim);
+}
+
+/* measure_tree(): adds the possession of `node` and of every nodal node
+ below it to `size`. With `ignited`, every ignited ceiling is also listed
+ with the bytes of its own possession, after all those below it. */
+void measure_tree(node_t *node, tree_size &size, std::vector<std::pair<node_t*, std::size_t>> *ignited)
+{
+    nodal_pocession<mcts_node_info> *context = node->get_context();
+    const std::size_t bytes = context->memory_usage();
+    size.bytes += bytes;
+    size.nodal_nodes++;
+    for(node_t &below : context->node_pool)
+    {
+        if(below.is_nodal())
+        {
+            measure_tree(&below, size, ignited);
+        }
+    }
+    if(ignited != nullptr && node->is_ceiling())
+    {
+        ignited->emplace_back(node, bytes);
+    }
+}
+
+/* count_possession(): adds to `bytes` what the possession of the nodal
+ `node` grew by since it was last counted. Only the pool entries made since
+ then are measured, each as it is when first seen, so the count costs time in
+ the new entries rather than in the size of the pools. */
+void count_possession(node_t *node, std::size_t &bytes)
+{
+    auto &info = node->get_info();
+    const nodal_pocession<mcts_node_info> &context = *node->get_context();
+    if(info.counted_cells == 0)
+    {
+        // a new possession; its cell pool starts with the cell of the universe
+        bytes += sizeof(nodal_pocession<mcts_node_info>) + context.hc_info.memory_usage() - sizeof(HC_info);
+    }
+    for(; info.counted_nodes < context.node_pool.size(); info.counted_nodes++)
+    {
+        // each node is the child of one node and owns about one cell
+        bytes += sizeof(node_t) + sizeof(node_t*) + sizeof(fine_cell<mcts_node_info>*);
+    }
+    for(; info.counted_cells < context.cell_pool.size(); info.counted_cells++)
+    {
+        const fine_cell<mcts_node_info> &cell = context.cell_pool[info.counted_cells];
+        bytes += sizeof(fine_cell<mcts_node_info>) - sizeof(HC) - sizeof(search_space)
+            + cell.space.memory_usage() + cell.subspace.memory_usage();
+    }
+}
+
+// count_possession() for every nodal node on the path from `node` to the root
+void count_possessions(node_t *node, std::size_t &bytes)
+{
+    for(; node != nullptr; node = node->get_parent())
+    {
+        if(node->is_nodal())
+        {
+            count_possession(node, bytes);
+        }
+    }
+}
+
+/* count_tree(): the exact bytes of the tree and its table, as measure_tree()
+ and measure_table() give them; every possession is marked as counted, so that
+ count_possessions() adds only what grows from here */
+std::size_t count_tree(node_t *root, const mcts_transposition_table &table)
+{
+    const auto mark = [](node_t *node, const auto &self) -> void
+    {
+        auto &info = node->get_info();
+        info.counted_nodes = node->get_context()->node_pool.size();
+        info.counted_cells = node->get_context()->cell_pool.size();
+        for(node_t &below : node->get_context()->node_pool)
+        {
+            if(below.is_nodal())
+            {
+                self(&below, self);
+            }
+        }
+    };
+    mark(root, mark);
+    tree_size size;
+    measure_tree(root, size, nullptr);
+    measure_table(table, size);
+    return size.bytes;
+}
+
+/* release_cold_nodes(): first evicts the table entries no node uses, then
+ extinguishes the least visited ignited ceilings until the tree and its
+ table are estimated to fit in `target` bytes, and returns how many were
+ released. Nodes with a rollout in flight below them are kept: their
+ workers still hold pointers into the subtree. */
+std::size_t release_cold_nodes(node_t *root, mcts_transposition_table &table, std::size_t target, mcts_counters &counters)
 {
-    if(node->is_terminal())
+    tree_size size;
+    std::vector<std::pair<node_t*, std::size_t>> ignited;
+    measure_tree(root, size, &ignited);
+    std::size_t table_bytes = table_memory_usage(table);
+    if(size.bytes + table_bytes <= target)
     {
-        return node->get_context()->hc_info.s;
+        return 0;
     }
-    node_t *ceiling_node = node->get_nearby_ceiling();
-    assert(ceiling_node != nullptr && "rollout node should have a nearby ceiling node");
-    if(!ceiling_node->is_nodal())
+    counters.evicted_transpositions += evict_unclaimed(table);
+    table_bytes = table_memory_usage(table);
+    if(size.bytes + table_bytes <= target)
     {
-        ceiling_node->ignite();
+        return 0;
     }
-    return ceiling_node->get_context()->hc_info.s;
+    // the visit count below which possessions are released
+    std::vector<std::pair<std::size_t, std::size_t>> by_visits;
+    for(const auto &[node, bytes] : ignited)
+    {
+        if(node->get_info().virtual_loss.load(std::memory_order_relaxed) == 0)
+        {
+            by_visits.emplace_back(node->get_info().visits.load(std::memory_order_relaxed), bytes);
+        }
+    }
+    std::sort(by_visits.begin(), by_visits.end());
+    std::size_t threshold = 0;
+    std::size_t bytes = size.bytes + table_bytes;
+    for(const auto &[visits, own_bytes] : by_visits)
+    {
+        if(bytes <= target)
+        {
+            break;
+        }
+        threshold = visits;
+        bytes -= own_bytes;
+    }
+    // descendants come first, so no node is touched after an ancestor freed it
+    std::size_t released = 0;
+    for(const auto &[node, own_bytes] : ignited)
+    {
+        auto &info = node->get_info();
+        if(info.visits.load(std::memory_order_relaxed) <= threshold
+           && info.virtual_loss.load(std::memory_order_relaxed) == 0)
+        {
+            unclaim_below(node);
+            node->extinguish();
+            info.all_children_included = false;
+            info.fully_expanded = false;
+            info.counted_nodes = 0;
+            info.counted_cells = 0;
+            released++;
+        }
+    }
+    counters.evicted_transpositions += evict_unclaimed(table);
+    return released;
 }
 
-void backpropagate(node_t *node, float outcome)
+struct root_action_stats
 {
-    while(node != nullptr)
+    moveseq moves;
+    std::size_t visits;
+    float sum_reward;
+};
+
+// every visited action of the root, i.e. the first ceiling on each path
+void collect_root_actions(node_t *node, std::vector<root_action_stats> &actions)
+{
+    for(node_t *child : node->get_children())
     {
-        auto &info = node->get_info();
-#ifdef DEBUGMSG
-        float old_sum = info.sum_reward;
-#endif
-        info.visits++;
-        info.sum_reward += outcome;
-#ifdef DEBUGMSG
-        assert(!std::isnan(info.sum_reward));
-        (void)old_sum;
-#endif
-        node = node->get_parent();
+        const auto &info = child->get_info();
+        if(info.visits == 0)
+        {
+            continue;
+        }
+        if(child->is_ceiling())
+        {
+            actions.push_back({child->to_action(), info.visits, info.sum_reward});
+        }
+        else
+        {
+            collect_root_actions(child, actions);
+        }
     }
 }
 
-node_t *most_visited_child(node_t *node)
+// the ceiling node below `node` whose action consists of `moves`, in any order
+node_t *find_action_node(node_t *node, const moveseq &moves)
 {
-    node_t *best = nullptr;
     for(node_t *child : node->get_children())
     {
-        if(child->get_info().visits == 0)
+        if(child->is_ceiling())
         {
-            continue;
+            const moveseq child_moves = child->to_action();
+            if(std::is_permutation(child_moves.begin(), child_moves.end(),
+                                   moves.begin(), moves.end()))
+            {
+                return child;
+            }
         }
-        if(best == nullptr
-           || child->get_info().visits > best->get_info().visits)
+        else if(node_t *found = find_action_node(child, moves))
         {
-            best = child;
+            return found;
         }
     }
-    return best;
+    return nullptr;
+}
+
+// the search so far, with the tracked `bytes` of the tree; the caller holds the tree lock
+mcts_progress take_progress(node_t &tree, std::size_t bytes, const mcts_counters &counters)
+{
+    mcts_progress progress{
+        counters.iterations.load(std::memory_order_relaxed),
+        std::chrono::steady_clock::now(),
+        tree.get_info().visits.load(std::memory_order_relaxed),
+        tree.get_info().sum_reward.load(std::memory_order_relaxed),
+        {},
+        tree.get_context()->hc_info.s,
+        bytes};
+    node_t *node = &tree;
+    while(node_t *child = most_visited_child(node))
+    {
+        node = child;
+        if(node->is_ceiling())
+        {
+            progress.pv.push_back(node->to_action());
+            if(!node->is_nodal())
+            {
+                break;
+            }
+        }
+    }
+    return progress;
 }
 
 float terminal_outcome(const state &s)
@@ -202,6 +950,60 @@ float terminal_outcome(const state &s)
 void mcts_engine::initialize()
 {
     root = nullptr;
+    transpositions.clear();
+}
+
+void mcts_engine::start_new_game()
+{
+    root = nullptr;
+    transpositions.clear();
+    engine::start_new_game();
+}
+
+std::size_t mcts_engine::reuse_tree()
+{
+    const std::vector<std::string> &moves = get_position_moves();
+    // the tree must have been made as make_tree() would make it now
+    const bool history_guided = history_ordering.load();
+    if(!root || root->get_context()->ordering.has_value() != history_guided
+       || root->get_context()->shuffled.has_value() != (shuffled_order.load() && !history_guided)
+       || tree_setup != get_position_setup()
+       || moves.size() < tree_moves.size()
+       || !std::equal(tree_moves.begin(), tree_moves.end(), moves.begin()))
+    {
+        root = nullptr;
+        return 0;
+    }
+    node_t *node = root.get();
+    moveseq played;
+    for(std::size_t k = tree_moves.size(); k < moves.size(); k++)
+    {
+        if(moves[k] != "submit")
+        {
+            played.push_back(ext_move{moves[k]}.fm);
+            continue;
+        }
+        node = find_action_node(node, played);
+        if(node == nullptr || !node->is_nodal())
+        {
+            root = nullptr;
+            return 0;
+        }
+        played.clear();
+    }
+    if(!played.empty())
+    {
+        // the position is in the middle of an action
+        root = nullptr;
+        return 0;
+    }
+    if(node != root.get())
+    {
+        root = node->detach();
+        // the nodes above the new root are gone, and so are their claims
+        reclaim_transpositions(root.get(), transpositions);
+    }
+    return root->get_info().visits.load();
 }
 
 default_policy_result mcts_engine::default_policy(
@@ -213,144 +1015,491 @@ default_policy_result mcts_engine::default_policy(
         std::move(position),
         rollout_max_actions.load(),
         stop_token,
-        rng);
+        rng,
+        history_ordering.load() ? rollout_sampler::HISTORY_SEARCH : rollout_sampler::ORDERED_SEARCH);
     if(!result.winner.has_value())
     {
-        return {0.0f, result.termination};
+        return {0.0f, result.termination, result.first_action};
     }
     return {
         *result.winner ? -WINNING_SCORE : WINNING_SCORE,
-        result.termination
+        result.termination,
+        result.first_action
     };
 }
 
-void mcts_engine::on_option_changed(const std::string &key, const option_value_t &value)
+std::vector<default_policy_result> mcts_engine::leaf_rollouts(
+    state position,
+    std::size_t count,
+    std::stop_token stop_token,
+    std::mt19937 *rng)
 {
-    if(key == ROLLOUT_MAX_ACTIONS_OPTION)
+    if(count == 1)
     {
-        if(const auto *max_actions = std::get_if<int>(&value))
+        return {default_policy(std::move(position), stop_token, rng)};
+    }
+    std::vector<std::uint32_t> seeds;
+    if(rng != nullptr)
+    {
+        for(std::size_t k = 0; k < count; k++)
         {
-            rollout_max_actions.store(*max_actions);
+            seeds.push_back(static_cast<std::uint32_t>((*rng)()));
         }
-        return;
     }
-    engine::on_option_changed(key, value);
+    std::vector<default_policy_result> results(count);
+    rollout_pool->run(count, [&](std::size_t k)
+    {
+        std::optional<std::mt19937> own_rng;
+        if(!seeds.empty())
+        {
+            own_rng.emplace(seeds[k]);
+        }
+        results[k] = default_policy(position, stop_token, own_rng.has_value() ? &*own_rng : nullptr);
+    });
+    return results;
 }
 
-std::optional<action> mcts_engine::find_best_move(std::optional<int> depth_limit, std::optional<int> time_limit_ms, std::stop_token stop_token)
+void mcts_engine::prepare_rollout_pool(std::size_t worker_count, std::size_t rollouts)
 {
-    const auto search_started = std::chrono::steady_clock::now();
-    dprint("find_best_move()",
-           "depth_limit=", (depth_limit.has_value() ? std::to_string(*depth_limit) : "none"),
-           "time_limit_ms=", (time_limit_ms.has_value() ? std::to_string(*time_limit_ms) : "none"));
-    root = fine_node<mcts_node_info>::make_root(*get_current_state());
-    // if(root->is_terminal())
-    // {
-    //     dprint("find_best_move: root is terminal, returning nullopt");
-    //     return std::nullopt;
-    // }
-
-    // Convert depth_limit to iteration budget if provided
-    std::optional<std::size_t> iteration_limit;
-    if(depth_limit.has_value())
+    const std::size_t extra = rollouts - 1;
+    if(extra == 0)
     {
-        iteration_limit = static_cast<std::size_t>(depth_limit.value()) * DEPTH_TO_ITERATION_MULTIPLIER;
+        rollout_pool.reset();
     }
-
-    // Set deadline from time_limit_ms if provided
-    std::optional<std::chrono::steady_clock::time_point> deadline;
-    if(time_limit_ms.has_value())
+    else if(rollout_pool == nullptr || rollout_pool->size() != worker_count * extra)
     {
-        deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(time_limit_ms.value());
+        rollout_pool = std::make_unique<thread_pool>(worker_count * extra);
     }
+}
 
-    std::size_t iteration_count = 0;
-    std::size_t conclusive_rollouts = 0;
-    std::size_t inconclusive_rollouts = 0;
-    std::size_t terminal_tree_evaluations = 0;
-    std::optional<std::mt19937> rollout_rng;
-    if(rollout_seed.has_value())
+void mcts_engine::on_option_changed(const std::string &key, const option_value_t &value)
+{
+    if(key == ROLLOUT_MAX_ACTIONS_OPTION)
     {
-        rollout_rng.emplace(*rollout_seed);
+        if(const auto *max_actions = std::get_if<int>(&value))
+        {
+            rollout_max_actions.store(*max_actions);
+        }
+        return;
     }
-    while(!stop_token.stop_requested())
+    if(key == HISTORY_ORDERING_OPTION)
     {
-        if(iteration_limit.has_value() && iteration_count >= iteration_limit.value())
+        if(const auto *enabled = std::get_if<bool>(&value))
         {
-            dprint("find_best_move: iteration limit reached", iteration_count);
-            break;
+            history_ordering.store(*enabled);
         }
-        if(deadline.has_value() && std::chrono::steady_clock::now() >= deadline.value())
+        return;
+    }
+    if(key == HASH_OPTION)
+    {
+        if(const auto *mb = std::get_if<int>(&value); mb && *mb >= 0)
         {
-            dprint("find_best_move: time deadline reached", iteration_count);
-            break;
+            hash_mb.store(*mb);
+        }
+        return;
+    }
+    if(key == WIDENING_K_OPTION || key == WIDENING_ALPHA_OPTION || key == RAVE_EQUIVALENCE_OPTION)
+    {
+        if(const std::optional<double> number = number_option(value); number && *number >= 0.0)
+        {
+            (key == WIDENING_K_OPTION ? widening_k
+             : key == WIDENING_ALPHA_OPTION ? widening_alpha
+             : rave_equivalence).store(*number);
         }
-        node_t *node = tree_policy(root.get(), stop_token);
-        if(node == nullptr)
+        return;
+    }
+    if(key == WIDENING_ORDER_OPTION)
+    {
+        if(const auto *order = std::get_if<std::string>(&value); order && (*order == "random" || *order == "search"))
         {
-            dprint("find_best_move: tree_policy returned nullptr at iteration", iteration_count,
-                   "root_visits=", root->get_info().visits,
-                   "root_children=", root->get_children().size());
-            break;
+            shuffled_order.store(*order == "random");
         }
-        const bool terminal_leaf = node->is_terminal();
-        float outcome;
-        std::optional<rollout_termination> rollout_end;
-        if(terminal_leaf)
+        return;
+    }
+    if(key == INFO_INTERVAL_OPTION)
+    {
+        if(const auto *ms = std::get_if<int>(&value); ms && *ms >= 0)
         {
-            outcome = terminal_outcome(node->get_context()->hc_info.s);
-            ++terminal_tree_evaluations;
+            info_interval_ms.store(*ms);
         }
-        else
+        return;
+    }
+    if(key == ROLLOUTS_PER_LEAF_OPTION)
+    {
+        if(const auto *count = std::get_if<int>(&value); count && *count >= 1)
         {
-            const default_policy_result result = default_policy(
-                rollout_state(node),
-                stop_token,
-                rollout_rng.has_value() ? &*rollout_rng : nullptr);
-            outcome = result.score;
-            rollout_end = result.termination;
+            rollouts_per_leaf.store(*count);
         }
-        if(stop_token.stop_requested()
-           || rollout_end == rollout_termination::STOPPED)
+        return;
+    }
+    if(key == THREADS_OPTION)
+    {
+        if(const auto *count = std::get_if<int>(&value); count && *count >= 1)
         {
-            dprint("find_best_move: simulation aborted at iteration", iteration_count);
-            break;
+            threads.store(*count);
+        }
+        return;
+    }
+    engine::on_option_changed(key, value);
+}
+
+mcts_search_limits mcts_engine::make_limits(std::optional<int> depth_limit, std::optional<int> time_limit_ms) const
+{
+    mcts_search_limits limits;
+    limits.started = std::chrono::steady_clock::now();
+    limits.memory_budget = static_cast<std::size_t>(std::max(0, hash_mb.load())) << 20;
+    limits.widening = {widening_k.load(), widening_alpha.load()};
+    limits.rave_equivalence = rave_equivalence.load();
+    limits.rollouts_per_leaf = static_cast<std::size_t>(std::max(1, rollouts_per_leaf.load()));
+    if(const int interval = info_interval_ms.load(); interval > 0)
+    {
+        limits.progress_interval = std::chrono::milliseconds(interval);
+    }
+    // Convert depth_limit to iteration budget if provided
+    if(depth_limit.has_value())
+    {
+        limits.iterations = static_cast<std::size_t>(depth_limit.value()) * DEPTH_TO_ITERATION_MULTIPLIER;
+    }
+    // Set deadline from time_limit_ms if provided
+    if(time_limit_ms.has_value())
+    {
+        limits.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(time_limit_ms.value());
+    }
+    return limits;
+}
+
+std::unique_ptr<fine_node<mcts_node_info>> mcts_engine::make_tree(const state &position, std::uint32_t tree_index) const
+{
+    if(shuffled_order.load() && !history_ordering.load())
+    {
+        const std::uint32_t seed = rollout_seed.has_value()
+            ? *rollout_seed + tree_index
+            : std::random_device{}();
+        return fine_node<mcts_node_info>::make_shuffled_root(position, seed);
+    }
+    return fine_node<mcts_node_info>::make_root(position, {}, history_ordering.load());
+}
+
+void mcts_engine::grow_tree(
+    fine_node<mcts_node_info> &tree,
+    mcts_transposition_table &table,
+    const mcts_search_limits &limits,
+    std::stop_token stop_token,
+    std::size_t worker_count,
+    std::uint32_t first_seed,
+    mcts_counters &counters)
+{
+    /*
+     Tree-parallel search: every worker selects and expands under
+     `tree_mutex`, marks its path with a virtual loss, runs its rollout
+     without the lock and backs up the result with atomic updates.
+     */
+    std::mutex tree_mutex;
+    std::mutex stats_mutex;
+    std::atomic<bool> finished{false};
+    // the tree and its table, estimated as they grow; guarded by tree_mutex
+    std::size_t tree_bytes = count_tree(&tree, table);
+    // the size at which cold nodes are released; guarded by tree_mutex
+    std::size_t memory_check_bytes = limits.memory_budget;
+    std::size_t next_progress_check = PROGRESS_CHECK_INTERVAL; // guarded by tree_mutex
+    auto next_progress = limits.started + limits.progress_interval.value_or(std::chrono::milliseconds(0));
+    const auto run_worker = [&](std::size_t worker)
+    {
+        std::optional<std::mt19937> rollout_rng;
+        if(rollout_seed.has_value())
+        {
+            rollout_rng.emplace(*rollout_seed + first_seed + static_cast<std::uint32_t>(worker));
         }
-        if(!terminal_leaf)
+        while(!stop_token.stop_requested() && !finished.load(std::memory_order_relaxed))
         {
-            if(rollout_end == rollout_termination::WINNER
-               || rollout_end == rollout_termination::STALEMATE)
+            if(limits.iterations.has_value()
+               && counters.iterations_started.fetch_add(1, std::memory_order_relaxed) >= limits.iterations.value())
+            {
+                dprint("grow_tree: iteration limit reached", counters.iterations.load());
+                break;
+            }
+            if(limits.deadline.has_value() && std::chrono::steady_clock::now() >= limits.deadline.value())
             {
-                ++conclusive_rollouts;
+                dprint("grow_tree: time deadline reached", counters.iterations.load());
+                break;
+            }
+            node_t *node;
+            bool solved_leaf;
+            float outcome = 0.0f;
+            std::optional<state> position;
+            std::optional<std::uint64_t> rollout_position; // for RAVE
+            std::optional<mcts_progress> progress; // reported once the lock is released
+            {
+                std::lock_guard<std::mutex> lock(tree_mutex);
+                if(tree.get_info().proven_outcome.has_value())
+                {
+                    dprint("grow_tree: root solved", counters.iterations.load());
+                    finished = true;
+                    break;
+                }
+                if(limits.stop_when_decided && limits.deadline.has_value()
+                   && counters.iterations.load(std::memory_order_relaxed) % DECIDED_CHECK_INTERVAL == 0
+                   && line_decided(&tree, remaining_iterations(limits, counters)
+                                          * static_cast<double>(limits.rollouts_per_leaf)))
+                {
+                    dprint("grow_tree: best line decided", counters.iterations.load());
+                    finished = true;
+                    break;
+                }
+                if(limits.memory_budget != 0 && tree_bytes > memory_check_bytes)
+                {
+                    // release down to three quarters, so the next check has room
+                    counters.released_nodes += release_cold_nodes(&tree, table, limits.memory_budget / 4 * 3, counters);
+                    tree_bytes = count_tree(&tree, table);
+                    // if hot nodes keep the tree too big, let it grow a quarter before it is walked again
+                    memory_check_bytes = std::max(limits.memory_budget, tree_bytes + limits.memory_budget / 4);
+                }
+                if(limits.progress_interval.has_value()
+                   && counters.iterations.load(std::memory_order_relaxed) >= next_progress_check)
+                {
+                    next_progress_check = counters.iterations.load(std::memory_order_relaxed) + PROGRESS_CHECK_INTERVAL;
+                    if(const auto now = std::chrono::steady_clock::now(); now >= next_progress)
+                    {
+                        next_progress = now + *limits.progress_interval;
+                        progress = take_progress(tree, tree_bytes, counters);
+                    }
+                }
+                node = tree_policy(&tree, stop_token, limits);
+                if(node == nullptr)
+                {
+                    dprint("grow_tree: tree_policy returned nullptr at iteration", counters.iterations.load(),
+                           "root_visits=", tree.get_info().visits.load(),
+                           "root_children=", tree.get_children().size());
+                    finished = true;
+                    break;
+                }
+                auto &leaf = node->get_info();
+                if(!leaf.proven_outcome.has_value())
+                {
+                    if(node->is_terminal())
+                    {
+                        prove(node, terminal_outcome(node->get_context()->hc_info.s), counters);
+                    }
+                    else if(const std::optional<float> solved = solve(node))
+                    {
+                        prove(node, *solved, counters);
+                    }
+                }
+                solved_leaf = leaf.proven_outcome.has_value();
+                if(solved_leaf)
+                {
+                    outcome = *leaf.proven_outcome;
+                }
+                else
+                {
+                    position = rollout_state(node);
+                    if(limits.rave_equivalence > 0.0)
+                    {
+                        rollout_position = position->hash();
+                    }
+                }
+                count_possessions(node, tree_bytes);
+                attach_transpositions(node, table, tree_bytes, counters);
+                add_virtual_loss(node);
+            }
+            if(progress.has_value())
+            {
+                report_progress(*progress, limits);
+            }
+            std::vector<default_policy_result> results;
+            if(solved_leaf)
+            {
+                ++counters.terminal_tree_evaluations;
             }
             else
             {
-                ++inconclusive_rollouts;
+                results = leaf_rollouts(
+                    std::move(*position),
+                    limits.rollouts_per_leaf,
+                    stop_token,
+                    rollout_rng.has_value() ? &*rollout_rng : nullptr);
+            }
+            if(stop_token.stop_requested()
+               || std::ranges::any_of(results, [](const default_policy_result &result) {
+                      return result.termination == rollout_termination::STOPPED;
+                  }))
+            {
+                dprint("grow_tree: simulation aborted at iteration", counters.iterations.load());
+                remove_virtual_loss(node);
+                break;
             }
+            if(!solved_leaf)
+            {
+                float sum = 0.0f;
+                for(const default_policy_result &result : results)
+                {
+                    sum += result.score;
+                    if(result.termination == rollout_termination::WINNER
+                       || result.termination == rollout_termination::STALEMATE)
+                    {
+                        ++counters.conclusive_rollouts;
+                    }
+                    else
+                    {
+                        ++counters.inconclusive_rollouts;
+                    }
+                }
+                outcome = sum / static_cast<float>(results.size());
+                counters.rollouts += results.size();
+            }
+            if(limits.rave_equivalence > 0.0)
+            {
+                std::lock_guard<std::mutex> lock(tree_mutex);
+                if(solved_leaf)
+                {
+                    record_amaf(node, rollout_position, {}, outcome, table, tree_bytes);
+                }
+                for(const default_policy_result &result : results)
+                {
+                    record_amaf(node, rollout_position, result.first_action, result.score, table, tree_bytes);
+                }
+            }
+            backpropagate(node, outcome, solved_leaf ? 1 : results.size());
+            counters.iterations++;
+        }
+    };
+    if(worker_count == 1)
+    {
+        run_worker(0);
+        return;
+    }
+    search_stats &caller_stats = search_stats::local();
+    std::vector<std::jthread> workers;
+    for(std::size_t worker = 0; worker < worker_count; worker++)
+    {
+        workers.emplace_back([&, worker]()
+        {
+            search_stats::local().reset();
+            run_worker(worker);
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            caller_stats += search_stats::local();
+        });
+    }
+}
+
+void mcts_engine::report_search_metrics(
+    std::chrono::steady_clock::time_point search_started,
+    std::size_t iterations,
+    std::size_t worker_count,
+    const mcts_counters &counters)
+{
+    const double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - search_started).count();
+    const double visits_per_second = seconds > 0.0
+        ? static_cast<double>(iterations) / seconds
+        : 0.0;
+    record_search_speed(visits_per_second);
+    std::ostringstream info;
+    info << std::setprecision(17)
+         << "mcts_stats elapsed_seconds=" << seconds
+         << " iterations=" << iterations
+         << " ips=" << visits_per_second
+         << " rollouts=" << counters.rollouts.load()
+         << " rps=" << (seconds > 0.0 ? static_cast<double>(counters.rollouts.load()) / seconds : 0.0)
+         << " threads=" << worker_count
+         << " conclusive_rollouts=" << counters.conclusive_rollouts.load()
+         << " inconclusive_rollouts=" << counters.inconclusive_rollouts.load()
+         << " terminal_tree_evaluations=" << counters.terminal_tree_evaluations.load();
+    const std::size_t lookups = counters.transposition_lookups.load();
+    const std::size_t hits = counters.transposition_hits.load();
+    info << " proven_nodes=" << counters.proven_nodes.load()
+         << " tt_lookups=" << lookups
+         << " tt_hits=" << hits
+         << " tt_hit_rate=" << (lookups > 0 ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0);
+    send_info(info.str());
+    if constexpr(search_stats::enabled)
+    {
+        send_info("search_stats " + search_stats::local().to_string());
+    }
+}
+
+void mcts_engine::report_progress(const mcts_progress &progress, const mcts_search_limits &limits)
+{
+    const double seconds = std::chrono::duration<double>(progress.taken - limits.started).count();
+    std::ostringstream info;
+    info << std::setprecision(9)
+         << "mcts_progress elapsed_seconds=" << seconds
+         << " iterations=" << progress.iterations
+         << " ips=" << (seconds > 0.0 ? static_cast<double>(progress.iterations) / seconds : 0.0)
+         << " depth=" << progress.pv.size()
+         << " value=" << (progress.root_visits != 0
+                              ? progress.root_sum_reward / static_cast<float>(progress.root_visits)
+                              : 0.0f)
+         << " bytes=" << progress.bytes;
+    if(limits.memory_budget != 0)
+    {
+        info << " hashfull=" << std::min<std::size_t>(1000, progress.bytes * 1000 / limits.memory_budget);
+    }
+    info << " pv";
+    state s = progress.position;
+    for(std::size_t i = 0; i < progress.pv.size(); i++)
+    {
+        const action act = action::from_moveseq(progress.pv[i], s);
+        info << (i == 0 ? " " : " / ") << act.pgn(s);
+        std::optional<state> next = s.can_apply(act);
+        if(!next.has_value())
+        {
+            break;
         }
-        backpropagate(node, outcome);
-        iteration_count++;
+        s = std::move(*next);
+    }
+    send_info(info.str());
+}
+
+void mcts_engine::report_tree_size(std::size_t bytes, std::size_t nodal_nodes, std::size_t table_entries, const mcts_counters &counters)
+{
+    std::ostringstream info;
+    info << "mcts_tree bytes=" << bytes
+         << " nodal_nodes=" << nodal_nodes
+         << " released_nodes=" << counters.released_nodes.load()
+         << " tt_entries=" << table_entries
+         << " evicted_entries=" << counters.evicted_transpositions.load();
+    send_info(info.str());
+}
+
+std::optional<action> mcts_engine::find_best_move(std::optional<int> depth_limit, std::optional<int> time_limit_ms, std::stop_token stop_token)
+{
+    const auto search_started = std::chrono::steady_clock::now();
+    dprint("find_best_move()",
+           "depth_limit=", (depth_limit.has_value() ? std::to_string(*depth_limit) : "none"),
+           "time_limit_ms=", (time_limit_ms.has_value() ? std::to_string(*time_limit_ms) : "none"));
+    search_stats::local().reset();
+    const std::size_t reused_visits = reuse_tree();
+    if(!root)
+    {
+        transpositions.clear();
+        root = make_tree(*get_current_state(), 0);
     }
-    dprint("find_best_move: post-loop, iterations=", iteration_count,
+    tree_setup = get_position_setup();
+    tree_moves = get_position_moves();
+    send_info("mcts_reuse visits=" + std::to_string(reused_visits));
+    // if(root->is_terminal())
+    // {
+    //     dprint("find_best_move: root is terminal, returning nullopt");
+    //     return std::nullopt;
+    // }
+
+    mcts_search_limits limits = make_limits(depth_limit, time_limit_ms);
+    limits.stop_when_decided = is_clock_managed();
+    const std::size_t worker_count = static_cast<std::size_t>(std::max(1, threads.load()));
+    mcts_counters counters;
+    prepare_rollout_pool(worker_count, limits.rollouts_per_leaf);
+    grow_tree(*root, transpositions, limits, stop_token, worker_count, 0, counters);
+    dprint("find_best_move: post-loop, iterations=", counters.iterations.load(),
            "root_visits=", root->get_info().visits,
            "root_children=", root->get_children().size());
-    const auto report_search_metrics = [&]()
+    const auto report = [&]()
     {
-        const double seconds = std::chrono::duration<double>(
-            std::chrono::steady_clock::now() - search_started).count();
-        const std::size_t visits = root->get_info().visits;
-        const double visits_per_second = seconds > 0.0
-            ? static_cast<double>(visits) / seconds
-            : 0.0;
-        std::ostringstream info;
-        info << std::setprecision(17)
-             << "mcts_stats elapsed_seconds=" << seconds
-             << " iterations=" << visits
-             << " ips=" << visits_per_second
-             << " conclusive_rollouts=" << conclusive_rollouts
-             << " inconclusive_rollouts=" << inconclusive_rollouts
-             << " terminal_tree_evaluations=" << terminal_tree_evaluations;
-        send_info(info.str());
+        report_search_metrics(search_started, counters.iterations.load(), worker_count, counters);
+        tree_size size;
+        measure_tree(root.get(), size, nullptr);
+        measure_table(transpositions, size);
+        report_tree_size(size.bytes, size.nodal_nodes, size.table_entries, counters);
     };
     node_t *current_node = root.get();
     node_t *previous_node = nullptr;
@@ -414,7 +1563,7 @@ std::optional<action> mcts_engine::find_best_move(std::optional<int> depth_limit
         {
             best_ext_moves.emplace_back(fm);
         }
-        report_search_metrics();
+        report();
         double score_average = 0.0;
         for(float score : selected_scores)
         {
@@ -441,10 +1590,113 @@ std::optional<action> mcts_engine::find_best_move(std::optional<int> depth_limit
     else
     {
         dprint("find_best_move: returning nullopt",
-               "iterations=", iteration_count,
+               "iterations=", counters.iterations.load(),
                "root_visits=", root->get_info().visits,
                "root_children=", root->get_children().size());
-        report_search_metrics();
+        report();
+        return std::nullopt;
+    }
+}
+
+root_parallel_mcts_engine::root_parallel_mcts_engine(
+    std::unique_ptr<io_handler> io_handler,
+    std::optional<std::uint32_t> seed,
+    int max_rollout_actions)
+    : mcts_engine(std::move(io_handler), seed, max_rollout_actions)
+{
+    threads.store(static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+}
+
+std::optional<action> root_parallel_mcts_engine::find_best_move(std::optional<int> depth_limit, std::optional<int> time_limit_ms, std::stop_token stop_token)
+{
+    const auto search_started = std::chrono::steady_clock::now();
+    search_stats::local().reset();
+    const state position = *get_current_state();
+    const std::size_t tree_count = static_cast<std::size_t>(std::max(1, threads.load()));
+    mcts_search_limits limits = make_limits(depth_limit, time_limit_ms);
+    // the trees share the budget
+    limits.memory_budget /= tree_count;
+    mcts_counters counters;
+    prepare_rollout_pool(tree_count, limits.rollouts_per_leaf);
+    std::vector<std::vector<root_action_stats>> tree_actions(tree_count);
+    std::vector<std::size_t> tree_visits(tree_count, 0);
+    std::vector<tree_size> tree_sizes(tree_count);
+    {
+        search_stats &caller_stats = search_stats::local();
+        std::mutex stats_mutex;
+        std::vector<std::jthread> workers;
+        for(std::size_t k = 0; k < tree_count; k++)
+        {
+            workers.emplace_back([&, k]()
+            {
+                search_stats::local().reset();
+                // with history ordering, each tree learns in a table of its own
+                auto tree = make_tree(position, static_cast<std::uint32_t>(k));
+                mcts_transposition_table table;
+                // only the first tree reports its progress
+                mcts_search_limits tree_limits = limits;
+                if(k != 0)
+                {
+                    tree_limits.progress_interval.reset();
+                }
+                grow_tree(*tree, table, tree_limits, stop_token, 1, static_cast<std::uint32_t>(k), counters);
+                tree_visits[k] = tree->get_info().visits;
+                measure_tree(tree.get(), tree_sizes[k], nullptr);
+                measure_table(table, tree_sizes[k]);
+                collect_root_actions(tree.get(), tree_actions[k]);
+                std::lock_guard<std::mutex> lock(stats_mutex);
+                caller_stats += search_stats::local();
+            });
+        }
+    }
+
+    // merge the root actions of all trees by their move sets
+    std::vector<root_action_stats> merged;
+    std::unordered_map<std::uint64_t, std::vector<std::size_t>> by_hash;
+    std::size_t total_visits = 0;
+    for(std::size_t k = 0; k < tree_count; k++)
+    {
+        total_visits += tree_visits[k];
+        for(root_action_stats &entry : tree_actions[k])
+        {
+            std::vector<std::size_t> &bucket = by_hash[canonical_hash(entry.moves)];
+            auto same = std::find_if(bucket.begin(), bucket.end(), [&](std::size_t m) {
+                return std::is_permutation(merged[m].moves.begin(), merged[m].moves.end(),
+                                           entry.moves.begin(), entry.moves.end());
+            });
+            if(same == bucket.end())
+            {
+                bucket.push_back(merged.size());
+                merged.push_back(std::move(entry));
+            }
+            else
+            {
+                merged[*same].visits += entry.visits;
+                merged[*same].sum_reward += entry.sum_reward;
+            }
+        }
+    }
+    report_search_metrics(search_started, total_visits, tree_count, counters);
+    tree_size total_size;
+    for(const tree_size &size : tree_sizes)
+    {
+        total_size.bytes += size.bytes;
+        total_size.nodal_nodes += size.nodal_nodes;
+        total_size.table_entries += size.table_entries;
+    }
+    report_tree_size(total_size.bytes, total_size.nodal_nodes, total_size.table_entries, counters);
+    const auto best = std::max_element(merged.begin(), merged.end(),
+        [](const root_action_stats &a, const root_action_stats &b) {
+            return a.visits < b.visits;
+        });
+    if(best == merged.end())
+    {
         return std::nullopt;
     }
+    std::ostringstream score_info;
+    score_info << std::setprecision(9)
+               << "mcts_score average=" << best->sum_reward / static_cast<float>(best->visits)
+               << " root_actions=" << merged.size();
+    send_info(score_info.str());
+    return action::from_moveseq(best->moves, position);
 }
@@ -1,6 +1,7 @@
 #ifndef MCTS_H
 #define MCTS_H
 
+#include <chrono>
 #include <cstddef>
 #include <optional>
 #include <mutex>
@@ -9,12 +10,33 @@
 #include <memory>
 #include <random>
 #include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "uci.h"
 #include "finetree.h"
 #include "rollout.h"
 #include "uct.h"
+#include "thread_pool.h"
 
 constexpr int default_mcts_rollout_max_actions = 200;
+// memory budget of a search tree in MB ("Hash" option), 0 for no limit
+constexpr int default_mcts_hash_mb = 1024;
+
+// progressive widening ("widening-k", "widening-alpha" options), off while k is 0
+constexpr double default_mcts_widening_k = 0.0;
+constexpr double default_mcts_widening_alpha = 0.5;
+
+// RAVE ("rave-equivalence" option): the number of visits at which a child's own
+// statistics and its AMAF statistics weigh the same; 0 turns RAVE off
+constexpr double default_mcts_rave_equivalence = 0.0;
+
+// milliseconds between the `info mcts_progress` lines of a search ("info-interval"
+// option), 0 for none
+constexpr int default_mcts_info_interval_ms = 1000;
+
+// rollouts run in parallel from every selected leaf ("RolloutsPerLeaf" option)
+constexpr int default_mcts_rollouts_per_leaf = 1;
 
 constexpr float WINNING_SCORE = 1.0f;
 
@@ -22,38 +44,236 @@ struct default_policy_result
 {
     float score;
     rollout_termination termination;
+    moveseq first_action = {}; // for the AMAF statistics, empty if unknown
+};
+
+// the playouts in which a semimove was played, wherever it was played
+struct mcts_amaf_stats
+{
+    float sum_reward = 0.0f;
+    std::size_t visits = 0;
+};
+
+/*
+ Statistics shared by every ceiling node of the tree whose action leads to
+ the same position (see state::hash()), so that a position reached by
+ different lines is valued with the playouts of all of them.
+ With RAVE, `amaf` collects for every semimove playable from this position
+ (by kind, hotspot and target) the outcomes of the playouts whose action
+ from here contained it, whichever other semimoves came with it. Siblings in
+ the fine tree that share a semimove thus share its AMAF statistics.
+ */
+struct mcts_transposition
+{
+    std::atomic<float> sum_reward{0.0f};
+    std::atomic<std::size_t> visits{0};
+    std::size_t claims = 0; // nodes of the tree holding a pointer to this entry
+    std::unordered_map<std::uint64_t, mcts_amaf_stats> amaf; // guarded by the tree lock
 };
 
+/*
+ Guarded by the tree lock; entries never move, so nodes keep pointers to
+ them. The table counts towards the `Hash` budget: over budget, the entries
+ no node claims are evicted, and so are those of released subtrees.
+ */
+using mcts_transposition_table = std::unordered_map<std::uint64_t, mcts_transposition>;
+
+/*
+ The flags change only while the search holds the tree lock. The statistics
+ are atomics so that workers back up rollout results without it.
+ `virtual_loss` counts the workers whose rollout below this node is still
+ running; selection treats each of them as a lost playout, which steers
+ concurrent workers into different branches.
+ `proven_outcome` is the exact result of the subtree (in the scale of
+ WINNING_SCORE, from White's side) once it is solved: the node is terminal,
+ or one of its children is a proven win for the player choosing among them,
+ or it is fully expanded and all its children are proven.
+ */
 struct mcts_node_info
 {
     bool is_included; // is this node inside the mcts tree?
     bool all_children_included; // are all children of this node included in the mcts tree?
     bool fully_expanded; // are all children of this node expanded?
-    float sum_reward;
-    std::size_t visits;
+    std::optional<float> proven_outcome;
+    std::atomic<float> sum_reward;
+    std::atomic<std::size_t> visits;
+    std::atomic<std::uint32_t> virtual_loss;
+    mcts_transposition *transposition; // set once a nodal ceiling is looked up
+    // entries of a nodal node's pools already in its search's byte count
+    std::size_t counted_nodes;
+    std::size_t counted_cells;
     mcts_node_info()
     : is_included{false},
       all_children_included{false},
       fully_expanded{false},
+      proven_outcome{std::nullopt},
       sum_reward{0.0f},
-      visits{0} {}
+      visits{0},
+      virtual_loss{0},
+      transposition{nullptr},
+      counted_nodes{0},
+      counted_cells{0} {}
     mcts_node_info(const mcts_node_info&) = delete;
     mcts_node_info &operator=(const mcts_node_info&) = delete;
-    mcts_node_info(mcts_node_info&&) noexcept = default;
-    mcts_node_info &operator=(mcts_node_info&&) noexcept = default;
+    mcts_node_info(mcts_node_info &&other) noexcept
+    : is_included{other.is_included},
+      all_children_included{other.all_children_included},
+      fully_expanded{other.fully_expanded},
+      proven_outcome{other.proven_outcome},
+      sum_reward{other.sum_reward.load(std::memory_order_relaxed)},
+      visits{other.visits.load(std::memory_order_relaxed)},
+      virtual_loss{other.virtual_loss.load(std::memory_order_relaxed)},
+      transposition{other.transposition},
+      counted_nodes{other.counted_nodes},
+      counted_cells{other.counted_cells} {}
+    mcts_node_info &operator=(mcts_node_info &&other) noexcept
+    {
+        is_included = other.is_included;
+        all_children_included = other.all_children_included;
+        fully_expanded = other.fully_expanded;
+        proven_outcome = other.proven_outcome;
+        sum_reward.store(other.sum_reward.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        visits.store(other.visits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        virtual_loss.store(other.virtual_loss.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        transposition = other.transposition;
+        counted_nodes = other.counted_nodes;
+        counted_cells = other.counted_cells;
+        return *this;
+    }
+};
+
+/*
+ Progressive widening: a node visited N times may have at most
+ max(1, k * N^alpha) children in the tree, so that a node with many actions
+ is searched deeper before it is searched wider. Children are revealed in
+ the order the fine tree finds them.
+ */
+struct mcts_widening
+{
+    double k = default_mcts_widening_k;
+    double alpha = default_mcts_widening_alpha;
+};
+
+struct mcts_search_limits
+{
+    std::optional<std::size_t> iterations;
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    std::chrono::steady_clock::time_point started;
+    // stop once the most visited line cannot be overtaken before the deadline
+    bool stop_when_decided = false;
+    // bytes the nodal possessions of the tree may hold, 0 for no limit
+    std::size_t memory_budget = 0;
+    mcts_widening widening;
+    double rave_equivalence = default_mcts_rave_equivalence;
+    // report the progress of the search this often, never if unset
+    std::optional<std::chrono::milliseconds> progress_interval;
+    // a leaf's rollouts are backed up as their average with this weight
+    std::size_t rollouts_per_leaf = default_mcts_rollouts_per_leaf;
+};
+
+// counters shared by every worker of one search
+struct mcts_counters
+{
+    std::atomic<std::size_t> iterations_started{0}; // checked against the iteration limit
+    std::atomic<std::size_t> iterations{0};
+    std::atomic<std::size_t> rollouts{0};
+    std::atomic<std::size_t> conclusive_rollouts{0};
+    std::atomic<std::size_t> inconclusive_rollouts{0};
+    std::atomic<std::size_t> terminal_tree_evaluations{0}; // iterations ending at a terminal or solved node
+    std::atomic<std::size_t> proven_nodes{0};
+    std::atomic<std::size_t> released_nodes{0}; // nodal nodes dropped for the memory budget
+    std::atomic<std::size_t> transposition_lookups{0};
+    std::atomic<std::size_t> transposition_hits{0}; // lookups finding a position already in the table
+    std::atomic<std::size_t> evicted_transpositions{0}; // table entries dropped for the memory budget
+};
+
+/*
+ What an `info mcts_progress` line reports, copied from the tree under its
+ lock so that the line can be formatted after the lock is released.
+ `pv` holds the actions of the most visited line, down to the first ceiling
+ that is not ignited; `position` is the state they are played from.
+ */
+struct mcts_progress
+{
+    std::size_t iterations;
+    std::chrono::steady_clock::time_point taken;
+    std::size_t root_visits;
+    float root_sum_reward;
+    std::vector<moveseq> pv;
+    state position;
+    std::size_t bytes;
 };
 
 class mcts_engine : public engine
 {
 protected:
     std::unique_ptr<fine_node<mcts_node_info>> root;
+    // the positions of the ceiling nodes of `root`
+    mcts_transposition_table transpositions;
+    // the `position` line whose state `root` was made for
+    std::string tree_setup;
+    std::vector<std::string> tree_moves;
     std::optional<std::uint32_t> rollout_seed;
     std::atomic<int> rollout_max_actions;
+    // expand and roll out under a history_HC_ordering ("history-ordering" option)
+    std::atomic<bool> history_ordering{false};
+    // number of search workers sharing the tree ("Threads" option)
+    std::atomic<int> threads{1};
+    // memory budget of the tree in MB ("Hash" option)
+    std::atomic<int> hash_mb{default_mcts_hash_mb};
+    std::atomic<double> widening_k{default_mcts_widening_k};
+    std::atomic<double> widening_alpha{default_mcts_widening_alpha};
+    // reveal children in a random order instead of the fine tree's own
+    // ("widening-order" option, "random" or "search"); history-ordering wins
+    std::atomic<bool> shuffled_order{false};
+    std::atomic<double> rave_equivalence{default_mcts_rave_equivalence};
+    std::atomic<int> info_interval_ms{default_mcts_info_interval_ms};
+    std::atomic<int> rollouts_per_leaf{default_mcts_rollouts_per_leaf};
+    // runs the extra rollouts of every leaf; kept between searches
+    std::unique_ptr<thread_pool> rollout_pool;
     void on_option_changed(const std::string &key, const option_value_t &value) override;
     virtual default_policy_result default_policy(
         state position,
         std::stop_token stop_token,
         std::mt19937 *rng);
+    /* leaf_rollouts(): `count` default policies from `position`, all but the
+     first on `rollout_pool`. With `rng`, each rollout gets its own generator
+     seeded from it, so a seeded search stays reproducible. */
+    std::vector<default_policy_result> leaf_rollouts(
+        state position,
+        std::size_t count,
+        std::stop_token stop_token,
+        std::mt19937 *rng);
+    // sizes `rollout_pool` for `worker_count` workers running `rollouts` rollouts per leaf
+    void prepare_rollout_pool(std::size_t worker_count, std::size_t rollouts);
+    /* reuse_tree(): if the current position continues the line of `root`,
+     descend to the ceiling node of each action played since and make it the
+     new root. Returns the visits carried over; otherwise drops `root` and
+     returns 0. */
+    std::size_t reuse_tree();
+    mcts_search_limits make_limits(std::optional<int> depth_limit, std::optional<int> time_limit_ms) const;
+    // a new tree for `position` in the order the options ask for; `tree_index` varies the shuffle
+    std::unique_ptr<fine_node<mcts_node_info>> make_tree(const state &position, std::uint32_t tree_index) const;
+    /* grow_tree(): search `tree` with `worker_count` workers until a limit is
+     reached or stop is requested. Worker k rolls out with the engine seed
+     plus first_seed + k. The ceiling nodes of `tree` share statistics
+     through `table`. */
+    void grow_tree(
+        fine_node<mcts_node_info> &tree,
+        mcts_transposition_table &table,
+        const mcts_search_limits &limits,
+        std::stop_token stop_token,
+        std::size_t worker_count,
+        std::uint32_t first_seed,
+        mcts_counters &counters);
+    void report_search_metrics(
+        std::chrono::steady_clock::time_point search_started,
+        std::size_t iterations,
+        std::size_t worker_count,
+        const mcts_counters &counters);
+    void report_progress(const mcts_progress &progress, const mcts_search_limits &limits);
+    // `bytes` includes the transposition table of `table_entries` entries
+    void report_tree_size(std::size_t bytes, std::size_t nodal_nodes, std::size_t table_entries, const mcts_counters &counters);
 public:
     mcts_engine(
         std::unique_ptr<io_handler> io_handler,
@@ -64,6 +284,23 @@ public:
       rollout_seed(seed),
       rollout_max_actions(max_rollout_actions) {}
     void initialize() override;
+    void start_new_game() override;
+    std::optional<action> find_best_move(std::optional<int> depth_limit, std::optional<int> time_limit_ms, std::stop_token stop_token) override;
+};
+
+/*
+ Root-parallel MCTS: `Threads` independent trees (by default one per
+ hardware thread), each grown by its own worker with its own rollout seed.
+ The visits of the root actions of all trees are then merged by move set and
+ the action visited most often in total is played.
+ */
+class root_parallel_mcts_engine : public mcts_engine
+{
+public:
+    root_parallel_mcts_engine(
+        std::unique_ptr<io_handler> io_handler,
+        std::optional<std::uint32_t> seed = std::nullopt,
+        int max_rollout_actions = default_mcts_rollout_max_actions);
     std::optional<action> find_best_move(std::optional<int> depth_limit, std::optional<int> time_limit_ms, std::stop_token stop_token) override;
 };
 
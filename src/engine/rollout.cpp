@@ -2,6 +2,7 @@
 
 #include <utility>
 
+#include "history_ordering.h"
 #include "hypercuboid.h"
 
 namespace
@@ -29,7 +30,9 @@ generator<moveseq> iterative_search(
             continue;
         }
 
-        if(auto problem = hc_info.find_problem(*point, hc))
+        auto problem = hc_info.find_problem(*point, hc);
+        observe_point(order, *point, problem);
+        if(problem)
         {
             search_space.concat(hc.remove_slice(*problem));
         }
@@ -41,84 +44,118 @@ generator<moveseq> iterative_search(
     }
 }
 
+std::mt19937 &default_rng()
+{
+    static thread_local std::mt19937 rng(std::random_device{}());
+    return rng;
+}
+
+std::optional<moveseq> find_random_action(
+    const state &s,
+    std::stop_token stop_token,
+    std::mt19937 *rng,
+    rollout_sampler sampler)
+{
+    auto [hc_info, search_space] = HC_info::build_HC(s);
+    std::mt19937 &engine_rng = rng != nullptr ? *rng : default_rng();
+    switch(sampler)
+    {
+        case rollout_sampler::HISTORY_SEARCH:
+            return iterative_search(
+                hc_info,
+                std::move(search_space),
+                history_HC_ordering(hc_info, engine_rng),
+                stop_token).first();
+        case rollout_sampler::ORDERED_SEARCH:
+            break;
+    }
+    return iterative_search(
+        hc_info,
+        std::move(search_space),
+        lazy_random_HC_ordering(hc_info.universe, engine_rng),
+        stop_token).first();
+}
+
 } /* anonymous namespace */
 
 rollout_result rollout_inplace_detailed(
     state &s,
     int max_actions,
     std::stop_token stop_token,
-    std::mt19937 *rng)
+    std::mt19937 *rng,
+    rollout_sampler sampler)
 {
     std::size_t actions = 0;
+    moveseq first_action;
     for(int num_actions = 0; num_actions < max_actions; ++num_actions)
     {
         if(stop_token.stop_requested())
         {
-            return {rollout_termination::STOPPED, std::nullopt, actions};
+            return {rollout_termination::STOPPED, std::nullopt, actions, std::move(first_action)};
         }
 
         const auto [present, player] = s.get_present();
         (void)present;
-        auto [hc_info, search_space] = HC_info::build_HC(s);
-        random_HC_ordering order = rng != nullptr
-            ? random_HC_ordering(hc_info.universe, *rng)
-            : random_HC_ordering(hc_info.universe);
-        if(auto moves = iterative_search(
-               hc_info,
-               std::move(search_space),
-               std::move(order),
-               stop_token).first())
+        if(auto moves = find_random_action(s, stop_token, rng, sampler))
         {
             for(const full_move &move : *moves)
             {
                 s.apply_move(move);
             }
             s.submit();
+            if(actions == 0)
+            {
+                first_action = std::move(*moves);
+            }
             ++actions;
             continue;
         }
 
         if(stop_token.stop_requested())
         {
-            return {rollout_termination::STOPPED, std::nullopt, actions};
+            return {rollout_termination::STOPPED, std::nullopt, actions, std::move(first_action)};
         }
 
         if(s.get_mate_type() == mate_type::STALEMATE)
         {
-            return {rollout_termination::STALEMATE, std::nullopt, actions};
+            return {rollout_termination::STALEMATE, std::nullopt, actions, std::move(first_action)};
         }
         return {
             rollout_termination::WINNER,
             std::optional<bool>{!player},
-            actions
+            actions,
+            std::move(first_action)
         };
     }
-    return {rollout_termination::ACTION_LIMIT, std::nullopt, actions};
+    return {rollout_termination::ACTION_LIMIT, std::nullopt, actions, std::move(first_action)};
 }
 
 rollout_result rollout_detailed(
     state s,
     int max_actions,
     std::stop_token stop_token,
-    std::mt19937 *rng)
+    std::mt19937 *rng,
+    rollout_sampler sampler)
 {
-    return rollout_inplace_detailed(s, max_actions, stop_token, rng);
+    return rollout_inplace_detailed(s, max_actions, stop_token, rng, sampler);
 }
 
 std::optional<bool> rollout_inplace(
     state &s,
     int max_actions,
     std::stop_token stop_token,
-    std::mt19937 *rng)
+    std::mt19937 *rng,
+    rollout_sampler sampler)
 {
-    return rollout_inplace_detailed(s, max_actions, stop_token, rng).winner;
+    return rollout_inplace_detailed(s, max_actions, stop_token, rng, sampler).winner;
 }
 
 std::optional<bool> rollout(
     state s,
     int max_actions,
     std::stop_token stop_token,
-    std::mt19937 *rng)
+    std::mt19937 *rng,
+    rollout_sampler sampler)
 {
-    return rollout_detailed(std::move(s), max_actions, stop_token, rng).winner;
+    return rollout_detailed(std::move(s), max_actions, stop_token, rng, sampler).winner;
 }
@@ -6,6 +6,7 @@
 #include <random>
 #include <stop_token>
 
+#include "action.h"
 #include "state.h"
 
 enum class rollout_termination
@@ -16,11 +17,21 @@ enum class rollout_termination
     STOPPED
 };
 
+// How each rollout step finds its random action.
+enum class rollout_sampler
+{
+    // iterative_search() under a fresh lazy_random_HC_ordering
+    ORDERED_SEARCH,
+    // iterative_search() under a history_HC_ordering trained by earlier steps
+    HISTORY_SEARCH
+};
+
 struct rollout_result
 {
     rollout_termination termination;
     std::optional<bool> winner;
     std::size_t actions;
+    moveseq first_action; // the first action played, empty if there was none
 
     constexpr bool is_conclusive() const
     {
@@ -34,13 +45,15 @@ rollout_result rollout_inplace_detailed(
     state &s,
     int max_actions,
     std::stop_token stop_token = {},
-    std::mt19937 *rng = nullptr);
+    std::mt19937 *rng = nullptr,
+    rollout_sampler sampler = rollout_sampler::ORDERED_SEARCH);
 
 rollout_result rollout_detailed(
     state s,
     int max_actions,
     std::stop_token stop_token = {},
-    std::mt19937 *rng = nullptr);
+    std::mt19937 *rng = nullptr,
+    rollout_sampler sampler = rollout_sampler::ORDERED_SEARCH);
 
 // Returns the winning color (0 for white, 1 for black), or nullopt if
 // the rollout ends without a winner. Prefer the detailed API when the caller
@@ -49,13 +62,15 @@ std::optional<bool> rollout_inplace(
     state &s,
     int max_actions,
     std::stop_token stop_token = {},
-    std::mt19937 *rng = nullptr);
+    std::mt19937 *rng = nullptr,
+    rollout_sampler sampler = rollout_sampler::ORDERED_SEARCH);
 
 // Runs a rollout on a private copy of the supplied state.
 std::optional<bool> rollout(
     state s,
     int max_actions,
     std::stop_token stop_token = {},
-    std::mt19937 *rng = nullptr);
+    std::mt19937 *rng = nullptr,
+    rollout_sampler sampler = rollout_sampler::ORDERED_SEARCH);
 
 #endif
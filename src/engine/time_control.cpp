@@ -0,0 +1,40 @@
+#include "time_control.h"
+
+#include <algorithm>
+#include <cmath>
+
+int estimated_moves_to_go(const state &s)
+{
+    const auto [present, player] = s.get_present();
+    (void)player;
+    const auto [active_min, active_max] = s.get_active_range();
+    const int extra_timelines = std::max(0, active_max - active_min);
+    return std::max(clock_min_moves_to_go,
+                    clock_expected_game_turns - present - 2 * extra_timelines);
+}
+
+std::optional<int> allocate_move_time(const search_clock &clock, const state &s, double iterations_per_second)
+{
+    const bool player = s.get_present().second;
+    if(!clock.has_time(player))
+    {
+        return std::nullopt;
+    }
+    const double remaining = std::max(0, *clock.time_ms[player] - clock_move_overhead_ms);
+    const double increment = clock.increment_ms[player];
+    const int moves_to_go = clock.moves_to_go.has_value() && *clock.moves_to_go > 0
+        ? *clock.moves_to_go
+        : estimated_moves_to_go(s);
+    double budget = remaining / moves_to_go + increment;
+    if(iterations_per_second > 0.0)
+    {
+        budget = std::max(budget, 1000.0 * clock_min_iterations / iterations_per_second);
+    }
+    budget = std::min(budget, remaining / 2.0);
+    return std::max(1, static_cast<int>(std::floor(budget)));
+}
+
+bool selection_decided(std::size_t best_visits, std::size_t second_visits, double remaining)
+{
+    return static_cast<double>(best_visits) - static_cast<double>(second_visits) > remaining;
+}
@@ -0,0 +1,51 @@
+#ifndef TIME_CONTROL_H
+#define TIME_CONTROL_H
+
+#include <cstddef>
+#include <optional>
+
+#include "state.h"
+
+// the clock parameters of `go` (wtime, btime, winc, binc, movestogo)
+struct search_clock
+{
+    std::optional<int> time_ms[2]; // remaining time of White and Black
+    int increment_ms[2] = {0, 0};
+    std::optional<int> moves_to_go;
+
+    bool has_time(bool player) const { return time_ms[player].has_value(); }
+};
+
+// kept back from every allocation for the GUI and the engine's own latency
+constexpr int clock_move_overhead_ms = 30;
+// without `movestogo`, a game is expected to last this many turns
+constexpr int clock_expected_game_turns = 40;
+constexpr int clock_min_moves_to_go = 8;
+// a search is given time for at least this many iterations if the clock allows it
+constexpr double clock_min_iterations = 100.0;
+
+/*
+ estimated_moves_to_go(): the number of actions the side to move still has
+ to play. Each active timeline beyond the first is counted as two turns of
+ the game, since branching positions tend to be decided sooner.
+ */
+int estimated_moves_to_go(const state &s);
+
+/*
+ allocate_move_time(): milliseconds to spend on the next action of the side
+ to move in `s`, or nullopt if the clock does not give its remaining time.
+ The share of the remaining time for each move left is raised, where the
+ clock allows it, to leave room for clock_min_iterations at
+ `iterations_per_second` (ignored if zero). At most half of the remaining
+ time is used.
+ */
+std::optional<int> allocate_move_time(const search_clock &clock, const state &s, double iterations_per_second);
+
+/*
+ selection_decided(): true if a choice among options with these visit
+ counts cannot change when at most `remaining` more visits are made, i.e.
+ the most visited option leads the second by more than `remaining`.
+ */
+bool selection_decided(std::size_t best_visits, std::size_t second_visits, double remaining);
+
+#endif /* TIME_CONTROL_H */
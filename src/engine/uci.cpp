@@ -1,6 +1,8 @@
 #include <charconv>
+#include <chrono>
 #include <cstdlib>
 #include "uci.h"
+#include "mate_search.h"
 #include <pgnparser.h>
 #include <sstream>
 
@@ -52,6 +54,48 @@ void engine::stop_search()
     }
 }
 
+std::optional<action> engine::ponder_search(std::optional<int> depth_limit, std::optional<int> time_limit_ms, std::stop_token stop_token)
+{
+    return ponder_with([this, depth_limit](std::stop_token search_stop) {
+        return find_best_move(depth_limit, std::nullopt, search_stop);
+    }, time_limit_ms, stop_token);
+}
+
+std::optional<action> engine::ponder_with(
+    const std::function<std::optional<action>(std::stop_token)> &search,
+    std::optional<int> time_limit_ms,
+    std::stop_token stop_token)
+{
+    std::stop_source search_stop;
+    std::stop_callback forward_stop(stop_token, [&search_stop]() {
+        search_stop.request_stop();
+    });
+    // waits for ponderhit, then lets the search run for the time of `go`
+    std::jthread clock([this, time_limit_ms, &search_stop](std::stop_token clock_stop) {
+        std::unique_lock<std::mutex> lock(ponder_mutex);
+        if(!ponder_cv.wait(lock, clock_stop, [this]() { return !pondering.load(); })
+           || !time_limit_ms.has_value())
+        {
+            return;
+        }
+        ponder_cv.wait_for(lock, clock_stop, std::chrono::milliseconds(*time_limit_ms), []() { return false; });
+        if(!clock_stop.stop_requested())
+        {
+            search_stop.request_stop();
+        }
+    });
+    auto best_move = search(search_stop.get_token());
+    // a search that ends on its own still may not answer before ponderhit
+    {
+        std::unique_lock<std::mutex> lock(ponder_mutex);
+        ponder_cv.wait(lock, stop_token, [this]() {
+            return !pondering.load() || quit_requested.load();
+        });
+        pondering = false;
+    }
+    return best_move;
+}
+
 void engine::write_line(const std::string &line)
 {
     std::lock_guard<std::mutex> lock(io_mutex);
@@ -155,11 +199,38 @@ void engine::mainloop()
         {
             std::optional<int> time_limit_ms; // default: no time limit
             std::optional<int> depth_limit;   // default: no depth limit
+            std::optional<int> mate_actions;  // "go mate N" solves instead of searching
+            bool ponder = false;
+            search_clock clock;
             std::string token;
             int val;
             while(iss >> token)
             {
-                if(token == "movetime" && (iss >> val))
+                if(token == "ponder")
+                {
+                    ponder = true;
+                }
+                else if(token == "wtime" && (iss >> val))
+                {
+                    clock.time_ms[0] = val;
+                }
+                else if(token == "btime" && (iss >> val))
+                {
+                    clock.time_ms[1] = val;
+                }
+                else if(token == "winc" && (iss >> val))
+                {
+                    clock.increment_ms[0] = val;
+                }
+                else if(token == "binc" && (iss >> val))
+                {
+                    clock.increment_ms[1] = val;
+                }
+                else if(token == "movestogo" && (iss >> val))
+                {
+                    clock.moves_to_go = val;
+                }
+                else if(token == "movetime" && (iss >> val))
                 {
                     time_limit_ms = val;
                 }
@@ -167,7 +238,16 @@ void engine::mainloop()
                 {
                     depth_limit = val;
                 }
-                // can add more time control options here
+                else if(token == "mate" && (iss >> val))
+                {
+                    mate_actions = val;
+                }
+            }
+            bool managed = false;
+            if(!time_limit_ms.has_value() && s.has_value())
+            {
+                time_limit_ms = allocate_move_time(clock, *s, search_speed.load());
+                managed = time_limit_ms.has_value();
             }
             if(is_busy())
             {
@@ -175,8 +255,19 @@ void engine::mainloop()
             }
             else
             {
-                launch_async_task(task_state::searching, [this, depth_limit, time_limit_ms](std::stop_token st) {
-                    auto best_move = find_best_move(depth_limit, time_limit_ms, st);
+                // set before the task starts, so that an early ponderhit is not lost
+                pondering = ponder;
+                clock_managed = managed;
+                launch_async_task(task_state::searching, [this, depth_limit, time_limit_ms, ponder, mate_actions](std::stop_token st) {
+                    auto best_move = mate_actions.has_value() && ponder
+                        ? ponder_with([this, mate_actions](std::stop_token search_stop) {
+                              return solve_mate(*mate_actions, std::nullopt, search_stop);
+                          }, time_limit_ms, st)
+                        : mate_actions.has_value()
+                        ? solve_mate(*mate_actions, time_limit_ms, st)
+                        : ponder
+                        ? ponder_search(depth_limit, time_limit_ms, st)
+                        : find_best_move(depth_limit, time_limit_ms, st);
                     if(quit_requested.load())
                     {
                         return;
@@ -245,6 +336,14 @@ void engine::mainloop()
         {
             stop_search();
         }
+        else if(command == "ponderhit")
+        {
+            {
+                std::lock_guard<std::mutex> lock(ponder_mutex);
+                pondering = false;
+            }
+            ponder_cv.notify_all();
+        }
         else if(command == "setoption")
         {
             std::string token;
@@ -424,8 +523,10 @@ void engine::set_position(const std::string &position, const std::string &moves)
     // apply moves if any
     std::istringstream iss(moves);
     std::string move_str;
+    std::vector<std::string> move_tokens;
     while(iss >> move_str)
     {
+        move_tokens.push_back(move_str);
         if(move_str == "submit")
         {
             if(!candidate->submit())
@@ -455,6 +556,8 @@ void engine::set_position(const std::string &position, const std::string &moves)
         }
     }
     s = std::move(candidate);
+    position_setup = position;
+    position_moves = std::move(move_tokens);
 }
 
 engine::option_value_t engine::get_option(const std::string &key) const
@@ -517,6 +620,35 @@ void engine::set_option(const std::string &key, const option_value_t &value)
     on_option_changed(key, value);
 }
 
+std::optional<action> engine::solve_mate(int max_actions, std::optional<int> time_limit_ms, std::stop_token stop_token)
+{
+    if(!s.has_value())
+    {
+        return std::nullopt;
+    }
+    mate_search_options options;
+    options.stop_token = stop_token;
+    if(time_limit_ms.has_value())
+    {
+        options.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(*time_limit_ms);
+    }
+    const state position = *s;
+    const mate_search_result result = find_mate(position, max_actions, options);
+    std::ostringstream info;
+    info << "mate status="
+         << (result.status == mate_search_status::MATE ? "mate"
+             : result.status == mate_search_status::NO_MATE ? "none" : "unknown")
+         << " actions=" << max_actions
+         << " nodes=" << result.nodes
+         << " table_entries=" << result.table_entries;
+    send_info(info.str());
+    if(result.status != mate_search_status::MATE || result.line.empty())
+    {
+        return std::nullopt;
+    }
+    return action::from_moveseq(result.line.front(), position);
+}
+
 void engine::send_info(const std::string &info)
 {
     std::lock_guard<std::mutex> lock(io_mutex);
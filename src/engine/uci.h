@@ -11,10 +11,13 @@
 #include <atomic>
 #include <mutex>
 #include <functional>
+#include <string>
+#include <vector>
 #include "state.h"
 #include "variants.h"
 #include "action.h"
 #include "io_handler.h"
+#include "time_control.h"
 
 /*
  * 5DUCI (Universal 5D Chess Interface) engine base class
@@ -23,6 +26,8 @@
  * - initialize(): called once received "5duci" command. When this methods halts, the base class will send "5duciok" to the GUI.
  * - start_new_game(): called when the engine received "5ducinewgame" command. The derived class should reset its internal state to prepare for a new game.
  * - find_best_move(depth, time): called when the engine received "go" command. Return the best action found within the given limits. The base class will send "bestmove <move>" to the GUI after this method returns an action, or "nobestmove" if it returns std::nullopt.
+ *   Without `movetime`, the time limit is allocated from the clock parameters (wtime, btime, winc, binc, movestogo) if they are given; engines that call record_search_speed() get allocations adapted to their speed.
+ *   For "go ponder", the time limit is withheld and the search is stopped through `stop_token` instead, so an engine that honours the token supports pondering without further work.
  * on_option_changed(key, value): called when the engine received "setoption" command. The derived class may override this method to react to specific options instantly. The base class will store the option in a map and provide `get_option(key)` and `set_option(key, value)` methods for the derived class to access the options.
  */
 
@@ -39,12 +44,23 @@ public:
 
 private:
     std::optional<state> s;
+    // the `position` command that produced `s`
+    std::string position_setup;
+    std::vector<std::string> position_moves;
     std::unique_ptr<io_handler> io; 
     std::atomic<task_state> active_task{task_state::idle};
     std::jthread search_thread;
     std::thread ready_thread;
     std::atomic<bool> ready_pending{false};
     std::atomic<bool> quit_requested{false};
+    // set from `go ponder` until `ponderhit` or the end of that search
+    std::atomic<bool> pondering{false};
+    std::condition_variable_any ponder_cv;
+    std::mutex ponder_mutex;
+    // set when the time limit of the running search was allocated from the clock
+    std::atomic<bool> clock_managed{false};
+    // iterations per second of the last search, for allocate_move_time()
+    std::atomic<double> search_speed{0.0};
     std::condition_variable task_cv;
     std::mutex task_mutex;
     std::mutex io_mutex;
@@ -59,11 +75,30 @@ protected:
     }
     void write_line(const std::string &line);
     bool is_busy() const;
+    const std::string &get_position_setup() const { return position_setup; }
+    // the move tokens ("submit" included) played from the setup to the current state
+    const std::vector<std::string> &get_position_moves() const { return position_moves; }
     // Starts an asynchronous engine task and marks the engine busy until the callback finishes.
     // Use this for work that may block, such as initialize() or find_best_move().
     void launch_async_task(task_state task, std::function<void(std::stop_token)> work);
 
     virtual void on_option_changed(const std::string &key, const option_value_t &value);
+    /* ponder_search(): runs find_best_move() on the expected position without
+     a clock. `ponderhit` starts the clock of `time_limit_ms`; the result is
+     held back until `ponderhit` or `stop`. */
+    std::optional<action> ponder_search(std::optional<int> depth_limit, std::optional<int> time_limit_ms, std::stop_token stop_token);
+    // ponder_with(): the same for any `search`, which is given only the stop token
+    std::optional<action> ponder_with(
+        const std::function<std::optional<action>(std::stop_token)> &search,
+        std::optional<int> time_limit_ms,
+        std::stop_token stop_token);
+    // "go mate N": the first action of a forced mate within N actions, if the solver finds one
+    std::optional<action> solve_mate(int max_actions, std::optional<int> time_limit_ms, std::stop_token stop_token);
+    bool is_pondering() const { return pondering.load(); }
+    /* engines may stop a clock-managed search early once its choice cannot
+     change within the time left (see selection_decided() in time_control.h) */
+    bool is_clock_managed() const { return clock_managed.load(); }
+    void record_search_speed(double iterations_per_second) { search_speed.store(iterations_per_second); }
 public:
     engine(std::unique_ptr<io_handler> io_handler) : s(std::nullopt), io(std::move(io_handler)) {}
     virtual void initialize() = 0;
@@ -75,6 +110,8 @@ public:
     virtual void start_new_game()
     {
         s = std::nullopt;
+        position_setup.clear();
+        position_moves.clear();
     }
     void set_position(const std::string &position, const std::string &moves);
     option_value_t get_option(const std::string &key) const;
@@ -3,6 +3,7 @@
 #include <iterator>
 #include <sstream>
 #include "utils.h"
+#include "search_stats.h"
 
 HC::HC(std::initializer_list<integer_set> init_axes)
     : axes(init_axes)
@@ -68,6 +69,16 @@ size_t HC::volume() const
     return result;
 }
 
+size_t HC::memory_usage() const
+{
+    size_t result = sizeof(HC) + (axes.capacity() - axes.size()) * sizeof(integer_set);
+    for(const auto& axis : axes)
+    {
+        result += axis.memory_usage();
+    }
+    return result;
+}
+
 bool slice::contains(const point &p) const
 {
     for(const auto& [n, coords] : fixed_axes)
@@ -108,6 +119,17 @@ size_t search_space::volume() const
     return result;
 }
 
+size_t search_space::memory_usage() const
+{
+    size_t result = sizeof(search_space);
+    for(const auto& hc : hcs)
+    {
+        // each list node also holds two links
+        result += hc.memory_usage() + 2 * sizeof(void*);
+    }
+    return result;
+}
+
 bool search_space::empty() const
 {
     for(const auto& hc : hcs)
@@ -228,6 +250,7 @@ std::list<HC>::const_iterator search_space::end() const
 void search_space::concat(search_space &&other)
 {
     hcs.splice(hcs.end(), other.hcs);
+    search_stats::record_search_space(hcs.size());
 }
 
 void search_space::prune_empty()
@@ -251,6 +274,7 @@ search_space HC::remove_slice(const slice &s) const
             result.push_back(std::move(x));
         }
     }
+    search_stats::record_split(result.size());
     return result;
 }
 
@@ -269,6 +293,7 @@ search_space HC::remove_point(const point &p) const
             result.push_back(std::move(x));
         }
     }
+    search_stats::record_split(result.size());
     return result;
 }
 
@@ -299,6 +324,7 @@ search_space HC::remove_slice_carefully(const slice &s) const
             result.push_back(std::move(x));
         }
     }
+    search_stats::record_split(result.size());
     return result;
 }
 
@@ -362,6 +388,7 @@ search_space HC::remove_slice_if_good(const slice &s, index_t max_codim) const
             result.push_back(std::move(x));
         }
     }
+    search_stats::record_split(result.size());
     return result;
 }
 
@@ -419,3 +446,43 @@ std::string search_space::to_string() const
     }
     return result;
 }
+
+void HC::write(std::ostream &out) const
+{
+    write_le(out, static_cast<std::uint32_t>(axes.size()));
+    for(const integer_set &axis : axes)
+    {
+        axis.write(out);
+    }
+}
+
+HC HC::read(std::istream &in)
+{
+    const std::uint32_t dimension = read_le<std::uint32_t>(in);
+    std::vector<integer_set> axes;
+    for(std::uint32_t n = 0; n < dimension; n++)
+    {
+        axes.push_back(integer_set::read(in));
+    }
+    return HC(std::move(axes));
+}
+
+void search_space::write(std::ostream &out) const
+{
+    write_le(out, static_cast<std::uint64_t>(hcs.size()));
+    for(const HC &hc : hcs)
+    {
+        hc.write(out);
+    }
+}
+
+search_space search_space::read(std::istream &in)
+{
+    search_space result;
+    const std::uint64_t count = read_le<std::uint64_t>(in);
+    for(std::uint64_t k = 0; k < count; k++)
+    {
+        result.hcs.push_back(HC::read(in));
+    }
+    return result;
+}
@@ -8,6 +8,7 @@
 #include <list>
 #include <string>
 #include <map>
+#include <iosfwd>
 #include "integer_set.h"
 
 // a point in the multi-dimensional space
@@ -48,7 +49,12 @@ public:
     */
     std::pair<HC, HC> split(index_t n, index_t i) const;
     size_t dimension() const { return axes.size(); }
+    // bytes held by this hypercuboid, itself included
+    size_t memory_usage() const;
     std::string to_string(bool verbose=true) const;
+
+    void write(std::ostream &out) const;
+    static HC read(std::istream &in);
 };
 
 class slice
@@ -83,6 +89,17 @@ public:
     void prune_empty();
     std::string to_string() const;
     size_t size() const { return hcs.size(); }
+    // bytes held by this space, itself and the list nodes included
+    size_t memory_usage() const;
+    /*
+     write(out)/read(in): compact little-endian binary form, the number of
+     hypercuboids followed by each of them in order. It is meant for
+     checkpoints of a running search; the indices only make sense together
+     with the `HC_info` that produced the space. read() throws
+     std::runtime_error on truncated input.
+     */
+    void write(std::ostream &out) const;
+    static search_space read(std::istream &in);
 
     void push_back(HC hc);
     void push_front(HC hc);
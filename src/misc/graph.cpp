@@ -2,6 +2,7 @@
 #include <queue>
 #include <sstream>
 #include <algorithm>
+#include <bit>
 #include <cassert>
 
 #include "debug.h"
@@ -9,37 +10,39 @@
 void graph::add_edge(index_t u, index_t v)
 {
     assert(u!=v && "loops are not allowed");
-    adj[u][v] = true;
-    adj[v][u] = true;
+    row(u)[v / word_bits] |= word_t{1} << (v % word_bits);
+    row(v)[u / word_bits] |= word_t{1} << (u % word_bits);
 }
 
 void graph::remove_edge(index_t u, index_t v)
 {
-    adj[u][v] = false;
-    adj[v][u] = false;
+    row(u)[v / word_bits] &= ~(word_t{1} << (v % word_bits));
+    row(v)[u / word_bits] &= ~(word_t{1} << (u % word_bits));
 }
 
-
-bool graph::not_isolated(index_t u) const
+template<typename F>
+void graph::for_each_neighbor(index_t u, F f) const
 {
-    for(bool b : adj[u])
+    const word_t *r = row(u);
+    for(index_t w = 0; w < row_words; w++)
     {
-        if(b) return true;
+        for(word_t bits = r[w]; bits; bits &= bits - 1)
+        {
+            f(static_cast<index_t>(w * word_bits + std::countr_zero(bits)));
+        }
     }
-    return false;
+}
+
+bool graph::not_isolated(index_t u) const
+{
+    const word_t *r = row(u);
+    return std::any_of(r, r + row_words, [](word_t w) { return w != 0; });
 }
 
 std::vector<index_t> graph::neighbors(index_t u) const
 {
     std::vector<index_t> result;
-    result.reserve(n_vertices);
-    for(index_t v = 0; v < n_vertices; v++)
-    {
-        if(adj[u][v])
-        {
-            result.push_back(v);
-        }
-    }
+    for_each_neighbor(u, [&result](index_t v) { result.push_back(v); });
     return result;
 }
 
@@ -53,92 +56,93 @@ struct pathnode
     index_t previous; // previous pathnode
 };
 
-std::optional<std::vector<std::pair<index_t, index_t>>> graph::find_matching(std::vector<index_t> &include) const
+std::optional<graph::matching> graph::find_matching(std::vector<index_t> &include) const
+{
+    std::vector<index_t> mate(n_vertices, n_vertices);
+    return augment(mate, include);
+}
+
+/* Extends the matching `mate` (mate[u] == n_vertices if u is unmatched) by
+ one augmenting path for each vertex of `include` left unmatched. A path
+ may end at an unmatched vertex or at a vertex outside `include`, whose
+ pair is then dropped. The search is breadth first, with neighbors visited
+ in increasing order. */
+std::optional<graph::matching> graph::augment(std::vector<index_t> &mate, std::vector<index_t> &include) const
 {
     dprint("finding a match on" + to_string());
-    graph matched(n_vertices);
+    const index_t none = n_vertices;
     std::vector<bool> must_include(n_vertices, false);
     for(index_t n : include)
     {
         must_include[n] = true;
     }
+    std::vector<word_t> seen(row_words);
+    const auto mark = [&seen](index_t v) { seen[v / word_bits] |= word_t{1} << (v % word_bits); };
+    std::vector<pathnode> pn;
+    pn.reserve(n_vertices);
+    std::queue<index_t> q; // maintain a queue for BFS search
     for(index_t n : include)
     {
-        dprint("n=" + n);
         // if n is already matched, skip
-        if(matched.not_isolated(n)) continue;
+        if(mate[n] != none) continue;
         // otherwise, try to find a augumentation path starting from n
-        std::vector<bool> seen = adj[n];
-        seen[n] = true; // seen will be some nodes of odd distance from n (and n itself)
-        std::vector<pathnode> pn = {{n_vertices, n_vertices, n_vertices}}; // pn[0] is a placeholder
-        pn.reserve(n_vertices);
-        std::queue<index_t> q; // maintain a queue for BFS search
-        for (index_t m : neighbors(n))
-        {
+        std::copy(row(n), row(n) + row_words, seen.begin());
+        mark(n); // seen will be some nodes of odd distance from n (and n itself)
+        pn.assign(1, {none, none, none}); // pn[0] is a placeholder
+        q = {};
+        for_each_neighbor(n, [&](index_t m) {
             index_t index = static_cast<index_t>(pn.size());
             pn.push_back({.a=n, .b=m, .previous=0});
             q.push(index);
-        }
-        index_t augpathend = n_vertices;
+        });
+        index_t augpathend = none;
         while(!q.empty())
         {
             index_t index = q.front();
             pathnode p = pn[index];
             q.pop();
-            auto us = matched.neighbors(p.b);
-//            print_range("Was:", us);
-//            std::erase(us, p.a);
-//            index_t current_index = p.previous;
-//            while(pn[current_index].previous != n_vertices)
-//            {
-//                std::erase(us, pn[current_index].a);
-//                std::erase(us, pn[current_index].a);
-//                current_index = pn[current_index].previous;
-//            }
-//            print_range("Now:", us);
-            if(us.empty())
+            const index_t u = mate[p.b];
+            if(u == none)
             {
                 //if p.b is not matched, we can stop our augmentation path here
                 augpathend = index;
                 break;
             }
-            else
+            // otherwise, p.b is matched to some u (the new a)
+            if(!must_include[u])
             {
-                // otherwise, p.b is matched to some u (the new a)
-                index_t u = us[0];
-                if(!must_include[u])
-                {
-                    // if we don't have to include u, we can just drop the match p.b -- u
-                    matched.remove_edge(p.b, u);
-                    augpathend = index;
-                    break;
-                }
-                else
+                // if we don't have to include u, we can just drop the match p.b -- u
+                mate[p.b] = none;
+                mate[u] = none;
+                augpathend = index;
+                break;
+            }
+            // in the last case, continue the bfs search for all possible v (the new b)
+            mark(p.a);
+            index_t current_index = p.previous;
+            while(pn[current_index].previous != none)
+            {
+                mark(pn[current_index].a);
+                mark(pn[current_index].b);
+                current_index = pn[current_index].previous;
+            }
+            // scan the unseen neighbors of u a word at a time
+            const word_t *r = row(u);
+            for(index_t w = 0; w < row_words; w++)
+            {
+                word_t fresh = r[w] & ~seen[w];
+                seen[w] |= fresh;
+                for(; fresh; fresh &= fresh - 1)
                 {
-                    // in the last case, continue the bfs search for all possible v (the new b)
-                    seen[p.a] = true;
-                    index_t current_index = p.previous;
-                    while(pn[current_index].previous != n_vertices)
-                    {
-                        seen[pn[current_index].a] = true;
-                        seen[pn[current_index].b] = true;
-                        current_index = pn[current_index].previous;
-                    }
-                    for(index_t v : neighbors(u))
-                    {
-                        if(!seen[v])
-                        {
-                            index_t new_index = static_cast<index_t>(pn.size());
-                            pn.push_back({.a=u, .b=v, .previous=index});
-                            q.push(new_index);
-                            seen[v] = true;
-                        }
-                    }
+                    const index_t v = static_cast<index_t>(w * word_bits + std::countr_zero(fresh));
+                    index_t new_index = static_cast<index_t>(pn.size());
+                    pn.push_back({.a=u, .b=v, .previous=index});
+                    q.push(new_index);
                 }
             }
         }
         // if we have not found the augmentation path, there is no match
-        if(augpathend == n_vertices)
+        if(augpathend == none)
             return std::nullopt;
         // otherwise, modify the matching by takeing symmetric difference
         dprint("found augmenting path:");
@@ -146,24 +150,21 @@ std::optional<std::vector<std::pair<index_t, index_t>>> graph::find_matching(std
         {
             pathnode p = pn[augpathend];
             dprint(p.b, "...", p.a, "---");
-            matched.add_edge(p.a, p.b);
-            if(p.previous != 0)
+            if(p.previous != 0 && mate[pn[p.previous].b] == p.a)
             {
-                matched.remove_edge(pn[p.previous].b, p.a);
+                mate[pn[p.previous].b] = none;
             }
+            mate[p.a] = p.b;
+            mate[p.b] = p.a;
             augpathend = p.previous;
         }
-        dprint("Updated to:", matched.to_string());
     }
-    std::vector<std::pair<index_t,index_t>> result;
+    matching result;
     for(index_t i = 0; i < n_vertices; i++)
     {
-        for(index_t j = 0; j < i; j++)
+        if(mate[i] < i)
         {
-            if(matched.adj[i][j])
-            {
-                result.push_back(std::make_pair(i,j));
-            }
+            result.push_back(std::make_pair(i, mate[i]));
         }
     }
     return result;
@@ -184,22 +185,19 @@ std::string graph::to_string() const
     oss << " and edges:\n";
     for(index_t i = 0; i < n_vertices; i++)
     {
-        if(std::any_of(adj[i].begin(), adj[i].begin()+i, [](bool x){return x;}))
+        std::vector<index_t> lower;
+        for_each_neighbor(i, [&lower, i](index_t j) {
+            if(j < i) lower.push_back(j);
+        });
+        if(!lower.empty())
         {
             oss << i << " -- ";
-            for(index_t j = 0; j < i; j++)
+            for(index_t j : lower)
             {
-                if(adj[i][j])
-                {
-                    oss << j << ", ";
-                }
+                oss << j << ", ";
             }
             oss << "\n";
         }
-//        for(index_t j = 0; j < n_vertices; j++)
-//        {
-//            oss << adj[i][j];
-//        }
         oss << "\n";
     }
     return oss.str();
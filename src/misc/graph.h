@@ -1,8 +1,10 @@
 #ifndef GRAPH_H
 #define GRAPH_H
 
+#include <cstdint>
 #include <string>
 #include <optional>
+#include <utility>
 #include <vector>
 #include <cassert>
 #include "integer_set.h"
@@ -10,25 +12,38 @@
 class graph
 {
     // undirected graph of n vertices
-    // represented as an adjacency matrix
+    // represented as an adjacency matrix with one bit per entry; each row
+    // spans `row_words` 64-bit words so neighbor scans go word by word
+    using word_t = std::uint64_t;
+    static constexpr index_t word_bits = 64;
     index_t n_vertices;
-    std::vector<std::vector<bool>> adj;
+    index_t row_words;
+    std::vector<word_t> adj;
+
+    const word_t *row(index_t u) const { return adj.data() + static_cast<std::size_t>(u) * row_words; }
+    word_t *row(index_t u) { return adj.data() + static_cast<std::size_t>(u) * row_words; }
+    template<typename F>
+    void for_each_neighbor(index_t u, F f) const;
+    std::optional<std::vector<std::pair<index_t,index_t>>> augment(std::vector<index_t> &mate, std::vector<index_t>& include) const;
 public:
-    graph(index_t n): n_vertices{n}
+    using matching = std::vector<std::pair<index_t,index_t>>;
+
+    graph(index_t n)
+        : n_vertices{n},
+          row_words{static_cast<index_t>((n + word_bits - 1) / word_bits)},
+          adj(static_cast<std::size_t>(n) * row_words, 0)
     {
-        adj.resize(n);
-        for(index_t i = 0; i < n; i++)
-        {
-            adj[i].resize(n, false);
-        }
     }
     void add_edge(index_t u, index_t v);
     void remove_edge(index_t u, index_t v);
     bool not_isolated(index_t u) const;
     std::vector<index_t> neighbors(index_t u) const;
-    
-    std::optional<std::vector<std::pair<index_t,index_t>>> find_matching(std::vector<index_t>& include) const;
-    
+
+    /* find_matching(include): find a matching that covers every vertex in
+     `include`; other vertices may stay unmatched. Returns the matched pairs
+     (u, v) with u > v in increasing order of u. */
+    std::optional<matching> find_matching(std::vector<index_t>& include) const;
+
     std::string to_string() const;
 };
 
@@ -1,22 +1,129 @@
 #include "integer_set.h"
 #include <sstream>
+#include "utils.h"
 
-bool integer_set::contains(value_type value) const
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define INTEGER_SET_AVX2 1
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#define INTEGER_SET_SSE4 1
+#endif
+
+/*
+ Word-parallel kernels for the bulk operations. Every kernel works on the
+ first `n` blocks of its operands; callers are responsible for handling the
+ blocks beyond the shorter operand.
+ */
+namespace
 {
-    size_t block_index = value >> block_shift;
-    size_t bit_index = value & block_mask;
-    if(block_index >= data.size())
+using block_t = std::uint64_t;
+
+#if defined(INTEGER_SET_AVX2)
+constexpr std::size_t lane_blocks = 4;
+using lane_t = __m256i;
+inline lane_t load(const block_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+inline void store(block_t *p, lane_t v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+inline lane_t lane_and(lane_t a, lane_t b) { return _mm256_and_si256(a, b); }
+inline lane_t lane_or(lane_t a, lane_t b) { return _mm256_or_si256(a, b); }
+// ~b & a
+inline lane_t lane_andnot(lane_t a, lane_t b) { return _mm256_andnot_si256(b, a); }
+inline bool lane_disjoint(lane_t a, lane_t b) { return _mm256_testz_si256(a, b); }
+inline bool lane_zero(lane_t a) { return _mm256_testz_si256(a, a); }
+#elif defined(INTEGER_SET_SSE4)
+constexpr std::size_t lane_blocks = 2;
+using lane_t = __m128i;
+inline lane_t load(const block_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+inline void store(block_t *p, lane_t v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+inline lane_t lane_and(lane_t a, lane_t b) { return _mm_and_si128(a, b); }
+inline lane_t lane_or(lane_t a, lane_t b) { return _mm_or_si128(a, b); }
+inline lane_t lane_andnot(lane_t a, lane_t b) { return _mm_andnot_si128(b, a); }
+inline bool lane_disjoint(lane_t a, lane_t b) { return _mm_testz_si128(a, b); }
+inline bool lane_zero(lane_t a) { return _mm_testz_si128(a, a); }
+#endif
+
+void and_blocks(block_t *dst, const block_t *src, std::size_t n)
+{
+    std::size_t i = 0;
+#if defined(INTEGER_SET_AVX2) || defined(INTEGER_SET_SSE4)
+    for(; i + lane_blocks <= n; i += lane_blocks)
     {
-        return false;
+        store(dst + i, lane_and(load(dst + i), load(src + i)));
+    }
+#endif
+    for(; i < n; i++)
+    {
+        dst[i] &= src[i];
     }
-    return data[block_index] & (static_cast<block_t>(1) << bit_index);
 }
 
-bool integer_set::empty() const noexcept
+void or_blocks(block_t *dst, const block_t *src, std::size_t n)
+{
+    std::size_t i = 0;
+#if defined(INTEGER_SET_AVX2) || defined(INTEGER_SET_SSE4)
+    for(; i + lane_blocks <= n; i += lane_blocks)
+    {
+        store(dst + i, lane_or(load(dst + i), load(src + i)));
+    }
+#endif
+    for(; i < n; i++)
+    {
+        dst[i] |= src[i];
+    }
+}
+
+void andnot_blocks(block_t *dst, const block_t *src, std::size_t n)
+{
+    std::size_t i = 0;
+#if defined(INTEGER_SET_AVX2) || defined(INTEGER_SET_SSE4)
+    for(; i + lane_blocks <= n; i += lane_blocks)
+    {
+        store(dst + i, lane_andnot(load(dst + i), load(src + i)));
+    }
+#endif
+    for(; i < n; i++)
+    {
+        dst[i] &= ~src[i];
+    }
+}
+
+bool any_common_bit(const block_t *a, const block_t *b, std::size_t n)
+{
+    std::size_t i = 0;
+#if defined(INTEGER_SET_AVX2) || defined(INTEGER_SET_SSE4)
+    for(; i + lane_blocks <= n; i += lane_blocks)
+    {
+        if(!lane_disjoint(load(a + i), load(b + i)))
+        {
+            return true;
+        }
+    }
+#endif
+    for(; i < n; i++)
+    {
+        if(a[i] & b[i])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool all_zero(const block_t *a, std::size_t n)
 {
-    for(const block_t &block : data)
+    std::size_t i = 0;
+#if defined(INTEGER_SET_AVX2) || defined(INTEGER_SET_SSE4)
+    for(; i + lane_blocks <= n; i += lane_blocks)
+    {
+        if(!lane_zero(load(a + i)))
+        {
+            return false;
+        }
+    }
+#endif
+    for(; i < n; i++)
     {
-        if(block != 0)
+        if(a[i] != 0)
         {
             return false;
         }
@@ -24,27 +131,80 @@ bool integer_set::empty() const noexcept
     return true;
 }
 
-integer_set::size_type integer_set::size() const noexcept
+std::size_t popcount_blocks(const block_t *a, std::size_t n)
 {
-    size_type count = 0;
-    for(const block_t &block : data)
+    std::size_t i = 0;
+    std::size_t count = 0;
+#if defined(INTEGER_SET_AVX2)
+    /* nibble lookup popcount (Mula et al.): count the bits of every nibble
+    with a shuffle, then sum the bytes of each 64-bit lane with sad_epu8 */
+    if(n >= 2 * lane_blocks)
+    {
+        const __m256i lookup = _mm256_setr_epi8(
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i low_mask = _mm256_set1_epi8(0x0f);
+        __m256i total = _mm256_setzero_si256();
+        for(; i + lane_blocks <= n; i += lane_blocks)
+        {
+            const __m256i v = load(a + i);
+            const __m256i lo = _mm256_and_si256(v, low_mask);
+            const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+            const __m256i bytes = _mm256_add_epi8(
+                _mm256_shuffle_epi8(lookup, lo),
+                _mm256_shuffle_epi8(lookup, hi));
+            total = _mm256_add_epi64(total, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+        }
+        alignas(32) std::uint64_t lanes[lane_blocks];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), total);
+        count = static_cast<std::size_t>(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+    }
+#endif
+    for(; i < n; i++)
     {
-        count += std::popcount(block);
+        count += static_cast<std::size_t>(std::popcount(a[i]));
     }
     return count;
 }
 
-bool integer_set::intersects(const integer_set &other) const noexcept
+} /* anonymous namespace */
+
+const char *integer_set::simd_backend() noexcept
 {
-    size_t min_size = std::min(data.size(), other.data.size());
-    for(size_t i = 0; i < min_size; i++)
+#if defined(INTEGER_SET_AVX2)
+    return "avx2";
+#elif defined(INTEGER_SET_SSE4)
+    return "sse4.1";
+#else
+    return "scalar";
+#endif
+}
+
+bool integer_set::contains(value_type value) const
+{
+    size_t block_index = value >> block_shift;
+    size_t bit_index = value & block_mask;
+    if(block_index >= data.size())
     {
-        if(data[i] & other.data[i])
-        {
-            return true;
-        }
+        return false;
     }
-    return false;
+    return data[block_index] & (static_cast<block_t>(1) << bit_index);
+}
+
+bool integer_set::empty() const noexcept
+{
+    return all_zero(data.data(), data.size());
+}
+
+integer_set::size_type integer_set::size() const noexcept
+{
+    return popcount_blocks(data.data(), data.size());
+}
+
+bool integer_set::intersects(const integer_set &other) const noexcept
+{
+    size_t min_size = std::min(data.size(), other.data.size());
+    return any_common_bit(data.data(), other.data.data(), min_size);
 }
 
 bool integer_set::erase(value_type value)
@@ -70,28 +230,25 @@ integer_set integer_set::operator|(const integer_set &other) const
 
 integer_set integer_set::operator&(const integer_set &other) const
 {
-    integer_set result = *this;
-    result &= other;
+    // only the common prefix of blocks can survive, so avoid copying the rest
+    integer_set result;
+    size_t min_size = std::min(data.size(), other.data.size());
+    result.data.assign(data.begin(), data.begin() + min_size);
+    and_blocks(result.data.data(), other.data.data(), min_size);
     return result;
 }
 
 void integer_set::minus(const integer_set &other)
 {
     size_t min_size = std::min(data.size(), other.data.size());
-    for(size_t i = 0; i < min_size; i++)
-    {
-        data[i] &= ~other.data[i];
-    }
+    andnot_blocks(data.data(), other.data.data(), min_size);
 }
 
 integer_set &integer_set::operator|=(const integer_set &other)
 {
     size_t max_size = std::max(data.size(), other.data.size());
     data.resize(max_size, 0);
-    for(size_t i = 0; i < other.data.size(); i++)
-    {
-        data[i] |= other.data[i];
-    }
+    or_blocks(data.data(), other.data.data(), other.data.size());
     return *this;
 }
 
@@ -99,10 +256,7 @@ integer_set &integer_set::operator&=(const integer_set &other)
 {
     size_t min_size = std::min(data.size(), other.data.size());
     data.resize(min_size, 0);
-    for(size_t i = 0; i < min_size; i++)
-    {
-        data[i] &= other.data[i];
-    }
+    and_blocks(data.data(), other.data.data(), min_size);
     return *this;
 }
 
@@ -111,23 +265,39 @@ std::string integer_set::to_string() const
     std::ostringstream oss;
     oss << "{";
     bool first = true;
-    for(value_type block_index = 0; block_index < data.size(); block_index++)
-    {
-        const block_t &block = data[block_index];
-        for(value_type bit_index = 0; bit_index < block_bits; bit_index++)
+    for_each([&oss, &first](value_type value) {
+        if(!first)
         {
-            if(block & (static_cast<block_t>(1) << bit_index))
-            {
-                value_type value = (block_index << block_shift) | bit_index;
-                if(!first)
-                {
-                    oss << ", ";
-                }
-                oss << value;
-                first = false;
-            }
+            oss << ", ";
         }
-    }
+        oss << value;
+        first = false;
+    });
     oss << "}";
     return oss.str();
 }
+
+void integer_set::write(std::ostream &out) const
+{
+    std::size_t used = data.size();
+    while(used > 0 && data[used - 1] == 0)
+    {
+        used--;
+    }
+    write_le(out, static_cast<std::uint32_t>(used));
+    for(std::size_t k = 0; k < used; k++)
+    {
+        write_le(out, data[k]);
+    }
+}
+
+integer_set integer_set::read(std::istream &in)
+{
+    integer_set result;
+    const std::uint32_t used = read_le<std::uint32_t>(in);
+    for(std::uint32_t k = 0; k < used; k++)
+    {
+        result.data.push_back(read_le<block_t>(in));
+    }
+    return result;
+}
@@ -11,12 +11,19 @@
 #include <type_traits>
 #include <string>
 #include <cassert>
+#include <iosfwd>
 
 using index_t = std::uint_fast16_t;
 
 /* dynamic integer bit-set 
 store a set of non-negative integers
 unlike std::bitset<N>, the size of integer_set is dynamic and can grow as needed
+
+bulk operations (&, |, minus, intersects, size, empty) are implemented by
+word-parallel kernels in integer_set.cpp. When the translation unit is
+compiled with AVX2 or SSE4.1 enabled (e.g. -DNATIVE_ARCH=ON), four or two
+blocks are processed per instruction; otherwise a scalar loop is used.
+`simd_backend()` reports which variant was compiled in.
 */
 class integer_set
 {
@@ -150,6 +157,8 @@ public:
     [[nodiscard]] bool empty() const noexcept;
     [[nodiscard]] size_type size() const noexcept;
     [[nodiscard]] bool intersects(const integer_set &other) const noexcept;
+    /* memory_usage(): bytes held by this set, itself included */
+    [[nodiscard]] size_type memory_usage() const noexcept { return sizeof(integer_set) + data.capacity() * sizeof(block_t); }
 
     iterator begin() { return iterator(this, 0, 0); }
     iterator end() { return iterator(this, static_cast<value_type>(data.size()), 0); }
@@ -164,6 +173,10 @@ public:
     void erase_if(Predicate pred);
     template <typename UnaryOp>
     [[nodiscard]] constexpr integer_set transform(UnaryOp op) const;
+    /* for_each(f): call f(i) for every element i in increasing order
+    skips empty blocks and jumps between set bits using countr_zero */
+    template <typename UnaryFunction>
+    constexpr void for_each(UnaryFunction f) const;
 
     integer_set operator |(const integer_set &other) const;
     integer_set operator &(const integer_set &other) const;
@@ -173,6 +186,15 @@ public:
     integer_set &operator &=(const integer_set &other);
 
     std::string to_string() const;
+
+    /* write(out)/read(in): binary form used by search checkpoints, the number
+    of blocks up to the last non-empty one followed by the blocks */
+    void write(std::ostream &out) const;
+    static integer_set read(std::istream &in);
+
+    /* name of the bulk-operation kernel selected at compile time:
+    "avx2", "sse4.1" or "scalar" */
+    static const char *simd_backend() noexcept;
 };
 
 template<>
@@ -188,23 +210,39 @@ struct std::iterator_traits<integer_set::const_iterator>
 };
 
 
+template <typename UnaryFunction>
+constexpr void integer_set::for_each(UnaryFunction f) const
+{
+    for(value_type block_index = 0; block_index < data.size(); block_index++)
+    {
+        block_t block = data[block_index];
+        while(block != 0)
+        {
+            const auto bit_index = static_cast<value_type>(std::countr_zero(block));
+            block &= block - 1;
+            f(static_cast<value_type>((block_index << block_shift) | bit_index));
+        }
+    }
+}
+
 template <typename Predicate>
 void integer_set::erase_if(Predicate pred)
 {
     for(value_type block_index = 0; block_index < data.size(); block_index++)
     {
-        block_t &block = data[block_index];
-        for(value_type bit_index = 0; bit_index < block_bits; bit_index++)
+        block_t remaining = data[block_index];
+        block_t erased = 0;
+        while(remaining != 0)
         {
-            if(block & (static_cast<block_t>(1) << bit_index))
+            const block_t lowest = remaining & (~remaining + 1);
+            remaining ^= lowest;
+            const auto bit_index = static_cast<value_type>(std::countr_zero(lowest));
+            if(pred(static_cast<value_type>((block_index << block_shift) | bit_index)))
             {
-                value_type value = (block_index << block_shift) | bit_index;
-                if(pred(value))
-                {
-                    block &= ~(static_cast<block_t>(1) << bit_index);
-                }
+                erased |= lowest;
             }
         }
+        data[block_index] &= ~erased;
     }
 }
 
@@ -212,17 +250,9 @@ template <typename UnaryOp>
 constexpr integer_set integer_set::transform(UnaryOp op) const
 {
     integer_set result;
-    for(value_type block_index = 0; block_index < data.size(); ++block_index)
-    {
-        const auto &block = data[block_index];
-        for(value_type i = 0; i < block_bits; i++)
-        {
-            if(block & (static_cast<block_t>(1) << i))
-            {
-                result.insert(op((block_index << block_shift) | i));
-            }
-        }
-    }
+    for_each([&result, &op](value_type i) {
+        result.insert(op(i));
+    });
     return result;
 }
 
@@ -3,6 +3,10 @@
 
 #include <algorithm>
 #include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <random>
 #include <vector>
 #include "integer_set.h"
@@ -17,6 +21,11 @@ In principle `s` should be a subset of axis `n` of the hypercuboid, but there
 is no enforcement of this. Use at your own risk.
 
 The code is written as static polymorphism.
+
+An ordering may also learn from the search by providing
+`observe(p, problem)`: the searches report every point they examine together
+with its problem slice, or `std::nullopt` when the point was accepted. Use
+`observe_point()` to forward a report to any ordering.
 */
 
 template<typename T>
@@ -41,6 +50,15 @@ public:
 
 static_assert(HC_ordering<natural_HC_ordering>);
 
+template<HC_ordering Order>
+void observe_point(const Order &order, const point &p, const std::optional<slice> &problem)
+{
+    if constexpr(requires { order.observe(p, problem); })
+    {
+        order.observe(p, problem);
+    }
+}
+
 class random_HC_ordering
 {
     std::vector<std::vector<index_t>> orderings;
@@ -78,4 +96,182 @@ public:
 
 static_assert(HC_ordering<random_HC_ordering>);
 
+/*
+`lazy_random_HC_ordering` orders every axis by a uniformly random permutation,
+like `random_HC_ordering`, but is meant to be built once per search step:
+
+- its buffers are leased from a per-thread pool and handed back when the
+  ordering is destroyed, so nothing is allocated after the first few uses;
+- every axis is shuffled by a lazy Fisher-Yates cursor: a position is drawn
+  only when `for_each` first walks past it, and the walk stops as soon as
+  every element of `s` was visited;
+- when `s` is sparse and all of its elements are already placed, `for_each`
+  visits the set bits of `s` sorted by position instead of walking the axis.
+
+The ordering is still consistent: every call follows one permutation per
+axis. Numbers are drawn from the generator in the order the calls need them,
+so the same generator state and the same calls give the same orderings. The
+generator must outlive the ordering.
+*/
+class lazy_random_HC_ordering
+{
+    struct buffers
+    {
+        std::vector<index_t> perm;             // all axes, axis n at [perm_offset[n], perm_offset[n+1])
+        std::vector<std::size_t> perm_offset;
+        std::vector<std::size_t> drawn;        // perm[perm_offset[n], drawn[n]) is final
+        std::vector<std::size_t> position;     // position[pos_offset[n] + i]: where i is in perm
+        std::vector<std::size_t> pos_offset;
+        std::vector<index_t> sparse;
+    };
+    // `s` is sparse when it holds at most 1/sparse_ratio of the axis
+    static constexpr std::size_t sparse_ratio = 4;
+
+    std::unique_ptr<buffers> buf;
+    std::mt19937 *rng;
+
+    static std::mt19937 &default_rng()
+    {
+        static thread_local std::mt19937 rng(std::random_device{}());
+        return rng;
+    }
+    static std::vector<std::unique_ptr<buffers>> &pool()
+    {
+        static thread_local std::vector<std::unique_ptr<buffers>> free_buffers;
+        return free_buffers;
+    }
+    // uniform in [0, range) with one multiplication (Lemire's method)
+    static std::size_t bounded(std::mt19937 &rng, std::uint32_t range)
+    {
+        std::uint64_t m = static_cast<std::uint64_t>(rng()) * range;
+        if(static_cast<std::uint32_t>(m) < range)
+        {
+            const std::uint32_t threshold = -range % range;
+            while(static_cast<std::uint32_t>(m) < threshold)
+            {
+                m = static_cast<std::uint64_t>(rng()) * range;
+            }
+        }
+        return static_cast<std::size_t>(m >> 32);
+    }
+    void release()
+    {
+        if(buf)
+        {
+            pool().push_back(std::move(buf));
+        }
+    }
+public:
+    explicit lazy_random_HC_ordering(const HC &hc)
+        : lazy_random_HC_ordering(hc, default_rng())
+    {}
+
+    lazy_random_HC_ordering(const HC &hc, std::mt19937 &rng)
+        : rng(&rng)
+    {
+        std::vector<std::unique_ptr<buffers>> &free_buffers = pool();
+        if(free_buffers.empty())
+        {
+            buf = std::make_unique<buffers>();
+        }
+        else
+        {
+            buf = std::move(free_buffers.back());
+            free_buffers.pop_back();
+        }
+        buffers &b = *buf;
+        b.perm.clear();
+        b.perm_offset.assign(1, 0);
+        b.drawn.clear();
+        b.pos_offset.assign(1, 0);
+        for(index_t n = 0; n < hc.dimension(); n++)
+        {
+            b.drawn.push_back(b.perm.size());
+            hc[n].for_each([&](index_t i) { b.perm.push_back(i); });
+            const std::size_t extent = b.perm.size() == b.perm_offset.back() ? 0 : b.perm.back() + 1;
+            b.perm_offset.push_back(b.perm.size());
+            b.pos_offset.push_back(b.pos_offset.back() + extent);
+        }
+        b.position.resize(b.pos_offset.back());
+        for(index_t n = 0; n < hc.dimension(); n++)
+        {
+            for(std::size_t k = b.perm_offset[n]; k < b.perm_offset[n + 1]; k++)
+            {
+                b.position[b.pos_offset[n] + b.perm[k]] = k;
+            }
+        }
+    }
+
+    ~lazy_random_HC_ordering()
+    {
+        release();
+    }
+    lazy_random_HC_ordering(lazy_random_HC_ordering &&other) noexcept = default;
+    lazy_random_HC_ordering &operator=(lazy_random_HC_ordering &&other) noexcept
+    {
+        if(this != &other)
+        {
+            release();
+            buf = std::move(other.buf);
+            rng = other.rng;
+        }
+        return *this;
+    }
+
+    void for_each(index_t n, const integer_set& s, auto &&f) const
+    {
+        buffers &b = *buf;
+        const std::size_t begin = b.perm_offset[n], end = b.perm_offset[n + 1];
+        const std::size_t extent = b.pos_offset[n + 1] - b.pos_offset[n];
+        std::size_t *position = b.position.data() + b.pos_offset[n];
+        const std::size_t count = s.size();
+        if(count * sparse_ratio <= end - begin)
+        {
+            b.sparse.clear();
+            bool all_drawn = true;
+            for(index_t i : s)
+            {
+                if(i >= extent || position[i] >= b.drawn[n])
+                {
+                    all_drawn = false;
+                    break;
+                }
+                b.sparse.push_back(i);
+            }
+            if(all_drawn)
+            {
+                std::sort(b.sparse.begin(), b.sparse.end(), [&](index_t i, index_t j) {
+                    return position[i] < position[j];
+                });
+                for(index_t i : b.sparse)
+                {
+                    f(i);
+                }
+                return;
+            }
+        }
+        std::size_t visited = 0;
+        for(std::size_t k = begin; k < end && visited < count; k++)
+        {
+            if(k == b.drawn[n])
+            {
+                // one Fisher-Yates step: place a random undrawn element at k
+                const std::size_t j = k + bounded(*rng, static_cast<std::uint32_t>(end - k));
+                std::swap(b.perm[k], b.perm[j]);
+                position[b.perm[k]] = k;
+                position[b.perm[j]] = j;
+                b.drawn[n]++;
+            }
+            const index_t i = b.perm[k];
+            if(s.contains(i))
+            {
+                visited++;
+                f(i);
+            }
+        }
+    }
+};
+
+static_assert(HC_ordering<lazy_random_HC_ordering>);
+
 #endif /* ORDERING_H */
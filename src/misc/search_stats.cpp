@@ -0,0 +1,57 @@
+#include "search_stats.h"
+#include <algorithm>
+#include <sstream>
+
+search_stats &search_stats::local()
+{
+    static thread_local search_stats stats;
+    return stats;
+}
+
+void search_stats::reset()
+{
+    *this = search_stats{};
+}
+
+search_stats &search_stats::operator+=(const search_stats &other)
+{
+    points_taken += other.points_taken;
+    points_missed += other.points_missed;
+    for(std::size_t l = 0; l < LAYER_COUNT; l++)
+    {
+        rejections[l] += other.rejections[l];
+        layer_time[l] += other.layer_time[l];
+    }
+    slice_axes += other.slice_axes;
+    max_slice_axes = std::max(max_slice_axes, other.max_slice_axes);
+    hc_splits += other.hc_splits;
+    peak_search_space = std::max(peak_search_space, other.peak_search_space);
+    return *this;
+}
+
+std::string search_stats::to_string() const
+{
+    constexpr std::array<const char*, LAYER_COUNT> layer_names = {"jump_order", "present", "checks"};
+    std::uint64_t slices = 0;
+    for(std::uint64_t r : rejections)
+    {
+        slices += r;
+    }
+    std::ostringstream os;
+    os << "points_taken=" << points_taken
+       << " points_missed=" << points_missed;
+    for(std::size_t l = 0; l < LAYER_COUNT; l++)
+    {
+        os << " rejections_" << layer_names[l] << '=' << rejections[l];
+    }
+    for(std::size_t l = 0; l < LAYER_COUNT; l++)
+    {
+        os << " time_" << layer_names[l] << "_ms="
+           << std::chrono::duration<double, std::milli>(layer_time[l]).count();
+    }
+    os << " mean_slice_axes=" << (slices ? static_cast<double>(slice_axes) / slices : 0.0)
+       << " max_slice_axes=" << max_slice_axes
+       << " hc_splits=" << hc_splits
+       << " peak_search_space=" << peak_search_space;
+    return os.str();
+}
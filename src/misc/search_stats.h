@@ -0,0 +1,126 @@
+// instrumentation counters for the hypercuboid search
+
+#ifndef SEARCH_STATS_H
+#define SEARCH_STATS_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ `search_stats` counts the work done by the hypercuboid search on the
+ current thread: points taken, problems found by each layer of
+ `HC_info::find_problem()` together with the time spent in that layer, the
+ size of the problem slices, the hypercuboids created by splitting and the
+ largest search space seen.
+
+ The counters are only collected when the library is configured with
+ `-DSEARCH_STATS=on`. Otherwise `search_stats::enabled` is false, every
+ `record_*()` function has an empty body and `layer_timer` is an empty
+ object, so instrumented code compiles to what it was before.
+
+ Usage:
+
+     search_stats::local().reset();
+     for(moveseq mvs : info.search(std::move(space))) { ... }
+     std::cout << search_stats::local().to_string() << '\n';
+
+ Every thread has its own counters; use `+=` to combine them.
+ */
+struct search_stats
+{
+    // the layers of HC_info::find_problem(), in the order they run
+    enum layer : std::size_t
+    {
+        JUMP_ORDER, // jump_order_consistent()
+        PRESENT,    // test_present()
+        CHECKS,     // find_checks()
+        LAYER_COUNT
+    };
+
+#ifdef SEARCH_STATS
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+
+    std::uint64_t points_taken = 0;  // take_point() returned a point
+    std::uint64_t points_missed = 0; // take_point() found nothing
+    std::array<std::uint64_t, LAYER_COUNT> rejections{};
+    std::array<std::chrono::nanoseconds, LAYER_COUNT> layer_time{};
+    std::uint64_t slice_axes = 0;     // fixed axes summed over all problem slices
+    std::uint64_t max_slice_axes = 0;
+    std::uint64_t hc_splits = 0;      // hypercuboids created by removing a slice or a point
+    std::uint64_t peak_search_space = 0; // most hypercuboids held by one search_space
+
+    // counters of the calling thread
+    static search_stats &local();
+    void reset();
+    search_stats &operator+=(const search_stats &other);
+    // space-separated key=value pairs, times in milliseconds
+    std::string to_string() const;
+
+    static void record_point([[maybe_unused]] bool found)
+    {
+        if constexpr(enabled)
+        {
+            (found ? local().points_taken : local().points_missed)++;
+        }
+    }
+    static void record_rejection([[maybe_unused]] layer l, [[maybe_unused]] std::size_t fixed_axes)
+    {
+        if constexpr(enabled)
+        {
+            search_stats &stats = local();
+            stats.rejections[l]++;
+            stats.slice_axes += fixed_axes;
+            if(fixed_axes > stats.max_slice_axes)
+            {
+                stats.max_slice_axes = fixed_axes;
+            }
+        }
+    }
+    static void record_split([[maybe_unused]] std::size_t pieces)
+    {
+        if constexpr(enabled)
+        {
+            local().hc_splits += pieces;
+        }
+    }
+    static void record_search_space([[maybe_unused]] std::size_t size)
+    {
+        if constexpr(enabled)
+        {
+            search_stats &stats = local();
+            if(size > stats.peak_search_space)
+            {
+                stats.peak_search_space = size;
+            }
+        }
+    }
+
+    // adds the lifetime of the object to the time of a layer
+    class layer_timer
+    {
+#ifdef SEARCH_STATS
+        layer l;
+        std::chrono::steady_clock::time_point start;
+    public:
+        explicit layer_timer(layer l) : l(l), start(std::chrono::steady_clock::now()) {}
+        ~layer_timer()
+        {
+            local().layer_time[l] += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start);
+        }
+#else
+    public:
+        explicit layer_timer(layer) {}
+#endif
+        layer_timer(const layer_timer&) = delete;
+        layer_timer &operator=(const layer_timer&) = delete;
+    };
+};
+
+#endif /* SEARCH_STATS_H */
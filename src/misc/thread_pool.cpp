@@ -0,0 +1,68 @@
+#include "thread_pool.h"
+#include <latch>
+#include <stop_token>
+
+thread_pool::thread_pool(std::size_t thread_count)
+{
+    threads.reserve(thread_count);
+    for(std::size_t k = 0; k < thread_count; k++)
+    {
+        threads.emplace_back([this](std::stop_token stop_token)
+        {
+            while(true)
+            {
+                std::function<void()> job;
+                {
+                    std::unique_lock<std::mutex> lock(queue_mutex);
+                    if(!queue_cv.wait(lock, stop_token, [this]() { return !queue.empty(); }))
+                    {
+                        return;
+                    }
+                    job = std::move(queue.front());
+                    queue.pop_front();
+                }
+                job();
+            }
+        });
+    }
+}
+
+thread_pool::~thread_pool()
+{
+    // request_stop() wakes the threads through their stop tokens
+    for(std::jthread &thread : threads)
+    {
+        thread.request_stop();
+    }
+}
+
+void thread_pool::run(std::size_t count, const std::function<void(std::size_t)> &task)
+{
+    if(count == 0)
+    {
+        return;
+    }
+    if(threads.empty())
+    {
+        for(std::size_t k = 0; k < count; k++)
+        {
+            task(k);
+        }
+        return;
+    }
+    std::latch done(static_cast<std::ptrdiff_t>(count - 1));
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        for(std::size_t k = 1; k < count; k++)
+        {
+            queue.emplace_back([&task, &done, k]()
+            {
+                task(k);
+                done.count_down();
+            });
+        }
+    }
+    queue_cv.notify_all();
+    task(0);
+    done.wait();
+}
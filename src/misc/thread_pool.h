@@ -0,0 +1,43 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ A fixed set of threads that stay alive between batches of work.
+
+ Usage:
+
+     thread_pool pool(3);
+     pool.run(4, [&](std::size_t k) { results[k] = work(k); });
+
+ run(count, task) calls task(0) on the calling thread and task(1) to
+ task(count - 1) on the pool, and returns once all of them have finished.
+ Several threads may call run() at once; their tasks share the pool. A task
+ must not throw.
+ */
+class thread_pool
+{
+    std::mutex queue_mutex;
+    std::condition_variable_any queue_cv;
+    std::deque<std::function<void()>> queue; // guarded by queue_mutex
+    std::vector<std::jthread> threads;
+public:
+    explicit thread_pool(std::size_t thread_count);
+    ~thread_pool();
+    thread_pool(const thread_pool&) = delete;
+    thread_pool &operator=(const thread_pool&) = delete;
+    std::size_t size() const
+    {
+        return threads.size();
+    }
+    void run(std::size_t count, const std::function<void(std::size_t)> &task);
+};
+
+#endif /* THREAD_POOL_H */
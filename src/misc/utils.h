@@ -10,6 +10,9 @@
 #include <iterator>
 #include <optional>
 #include <type_traits>
+#include <concepts>
+#include <cstdint>
+#include <stdexcept>
 
 /*
 The append/concatenate functions.
@@ -209,4 +212,46 @@ constexpr T& operator &=(T& lhs, T rhs) noexcept {
     return lhs;
 }
 
+/*
+ Fixed-width little-endian integers for binary files (see search_space::write).
+ read_le() throws std::runtime_error when the stream ends early.
+ */
+template<std::unsigned_integral T>
+void write_le(std::ostream &out, T value)
+{
+    char bytes[sizeof(T)];
+    for(std::size_t k = 0; k < sizeof(T); k++)
+    {
+        bytes[k] = static_cast<char>(value >> (8 * k));
+    }
+    out.write(bytes, sizeof(T));
+}
+
+template<std::unsigned_integral T>
+T read_le(std::istream &in)
+{
+    unsigned char bytes[sizeof(T)];
+    if(!in.read(reinterpret_cast<char *>(bytes), sizeof(T)))
+    {
+        throw std::runtime_error("unexpected end of binary data");
+    }
+    T value = 0;
+    for(std::size_t k = 0; k < sizeof(T); k++)
+    {
+        value |= static_cast<T>(bytes[k]) << (8 * k);
+    }
+    return value;
+}
+
+/*
+ hash_mix(z): the splitmix64 finalizer. Combine values by mixing each step,
+ e.g. h = hash_mix(h ^ value).
+ */
+constexpr std::uint64_t hash_mix(std::uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
 #endif // UTILS_H
@@ -0,0 +1,120 @@
+#undef NDEBUG
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "integer_set.h"
+
+/*
+ Benchmark for the bulk operations of integer_set on wide axes.
+ A 100-timeline position produces axes with a few thousand entries, so the
+ sets below span 37 blocks (an odd count exercises the scalar tails of the
+ vectorized kernels). Every result is first checked against std::set.
+ */
+
+namespace
+{
+
+constexpr index_t universe_size = 37 * 64;
+constexpr int repetitions = 20000;
+
+integer_set random_set(std::mt19937 &rng, double density, std::set<index_t> &reference)
+{
+    std::bernoulli_distribution coin(density);
+    integer_set result;
+    for(index_t i = 0; i < universe_size; i++)
+    {
+        if(coin(rng))
+        {
+            result.insert(i);
+            reference.insert(i);
+        }
+    }
+    return result;
+}
+
+std::vector<index_t> snapshot(const integer_set &s)
+{
+    return std::vector<index_t>(s.begin(), s.end());
+}
+
+std::vector<index_t> snapshot(const std::set<index_t> &s)
+{
+    return std::vector<index_t>(s.begin(), s.end());
+}
+
+template<typename F>
+void bench(const char *name, F f)
+{
+    using clock = std::chrono::steady_clock;
+    std::size_t sink = 0;
+    const auto start = clock::now();
+    for(int i = 0; i < repetitions; i++)
+    {
+        sink += f();
+    }
+    const double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+    std::cout << "  " << name << ": " << ns / repetitions << " ns/op (checksum " << sink << ")\n";
+}
+
+} /* anonymous namespace */
+
+int main()
+{
+    std::mt19937 rng(20250918);
+    std::set<index_t> ra, rb;
+    const integer_set a = random_set(rng, 0.5, ra);
+    const integer_set b = random_set(rng, 0.3, rb);
+
+    // correctness against the reference implementation
+    std::set<index_t> r_and, r_or, r_minus;
+    for(index_t i : ra)
+    {
+        if(rb.contains(i)) r_and.insert(i);
+        else r_minus.insert(i);
+        r_or.insert(i);
+    }
+    r_or.insert(rb.begin(), rb.end());
+    assert(snapshot(a & b) == snapshot(r_and));
+    assert(snapshot(a | b) == snapshot(r_or));
+    integer_set m = a;
+    m.minus(b);
+    assert(snapshot(m) == snapshot(r_minus));
+    assert(a.size() == ra.size());
+    assert(a.intersects(b) == !r_and.empty());
+    assert(!m.intersects(b));
+    assert(!a.empty() && integer_set{}.empty());
+
+    std::vector<index_t> visited;
+    a.for_each([&visited](index_t i) { visited.push_back(i); });
+    assert(visited == snapshot(ra));
+
+    integer_set odd = a;
+    odd.erase_if([](index_t i) { return i % 2 == 0; });
+    std::set<index_t> r_odd;
+    for(index_t i : ra) if(i % 2) r_odd.insert(i);
+    assert(snapshot(odd) == snapshot(r_odd));
+
+    const integer_set shifted = b.transform([](index_t i) { return static_cast<index_t>(i + 3); });
+    std::set<index_t> r_shifted;
+    for(index_t i : rb) r_shifted.insert(static_cast<index_t>(i + 3));
+    assert(snapshot(shifted) == snapshot(r_shifted));
+
+    std::cout << "integer_set kernels: " << integer_set::simd_backend()
+              << ", " << universe_size << " bits per set\n";
+    bench("operator&", [&]() { return (a & b).size(); });
+    bench("operator|", [&]() { return (a | b).size(); });
+    bench("minus", [&]() { integer_set c = a; c.minus(b); return c.size(); });
+    bench("intersects", [&]() { return static_cast<std::size_t>(a.intersects(m) + m.intersects(b)); });
+    bench("size", [&]() { return a.size(); });
+    bench("for_each", [&]() { std::size_t sum = 0; a.for_each([&sum](index_t i) { sum += i; }); return sum; });
+    bench("iterator", [&]() { std::size_t sum = 0; for(index_t i : a) sum += i; return sum; });
+    bench("erase_if", [&]() { integer_set c = a; c.erase_if([](index_t i) { return i & 1; }); return c.size(); });
+    bench("transform", [&]() { return b.transform([](index_t i) { return static_cast<index_t>(i >> 1); }).size(); });
+    std::cerr << "---= bench_integer_set.cpp: all passed =---" << std::endl;
+    return 0;
+}
@@ -0,0 +1,121 @@
+#undef NDEBUG
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "state.h"
+#include "pgnparser.h"
+
+/*
+ Benchmark for state::get_mate_type() and state::is_softmate() on the
+ positions of test/pgn/softmate.5dpgn and test/pgn/manyChecks.5dpgn
+ (embedded so the benchmark runs from any directory).
+ */
+
+const std::string softmate_pgn = R"(
+[Mode "5D"]
+[Board "Standard"]
+1. e3 / Nf6
+2w. Bb5 {Beware!}
+(2b. d5 {The right response})
+2b. c6
+3. c3 / cxb5
+4. Qb3 / Qa5
+5. Q>>xf7+~ (~T1) (>L1) {f7-sacrifice!} / (1T1)Kxf7
+6. (1T2)Nh3 / (1T2)e6
+7. (1T3)e3 / (1T3)Qf6
+8. (1T4)Qh5* / (0T5)Qa5>>(0T1)a5 
+9. (-1T2)e3e4 / (-1T2)Ng8h6 
+(10w. (-1T3)e4e5 / (-1T3)Rh8g8 
+11. (-1T4)e5e6 / (-1T4)Nh6>x(1T4)h5 {recapture}
+12. (-1T5)e6xf7 (1T5)Nh3g5 )
+10w. (-1T3)Bf1c4 / (-1T3)Rh8g8 
+11. (-1T4)Bc4xf7 1-0
+)";
+
+const std::string many_checks_pgn = R"(
+[Mode "5D"]
+[Board "Standard"]
+1.(0T1)Ng1f3 / (0T1)c7c6 
+2.(0T2)Nf3e5 / (0T2)Ng8>>(0T1)g6 
+3.(-1T2)d2d3 / (-1T2)Nb8c6 
+4.(-1T3)h2h4 (0T3)Ne5d7 / (0T3)Ke8d7 (-1T3)d7d5 
+5.(0T4)h2h3 (-1T4)Bc1f4 / (0T4)Qd8a5 (-1T4)Ng6f4 
+6.(0T5)Qd1>>(-1T4)d2 / (1T4)Qd8>>(-1T4)b6 
+7.(-2T5)Nb1a3 (-1T5)b2b4 (1T5)c2c4 / (1T5)Bc8g4 (0T5)e7e6 (-1T5)Nc6b4 (-2T5)Qb6b4 
+8.(-2T6)Qd1d2 (-1T6)e2e3 (0T6)c2c3 (1T6)e2e3 / (0T6)Qa5>(1T6)b6 (-1T6)Bc8g4 (-2T6)Qb4f4 
+9.(-2T7)Ra1c1 (-1T7)a2a4 (0T7)f2f3 (1T7)c4d5 / (-1T7)Nf4>(0T7)h4 (1T7)Bg4>>(0T7)g3 (-2T7)Qf4d2 
+10.(-2T8)Nf3d2 (-1T8)Rh1g1 (0T8)g2g3 (1T8)d5c6 / (1T8)Ke8c8 (0T8)Bf8d6 (-1T8)e7e6 (-2T8)b7b5 
+11.(-2T9)Na3b5 (-1T9)d3d4 (0T9)g3h4 (1T9)Qd2b4 / (1T9)Qb6b4 (0T9)Bd6g3 (-1T9)Qd8d6 (-2T9)e7e5 
+12.(-2T10)Nb5a7 (-1T10)c2c3 (0T10)Ke1d1 (1T10)Qd1d2 / (1T10)a7a5 (0T10)Bg3>>(1T10)g4 (-1T10)Ng8f6 (-2T10)Nc6d4 
+13.(1T11)Qd2b4 (0T11)Rh1g1 (-1T11)c3b4 (-2T11)Na7c8 / (1T11)a5b4 (0T11)Nb8a6 (-1T11)Qd6b4 (-2T11)Ra8c8 
+14.(-3T8)Ke1>>(-2T8)d2 / (2T8)Nc6>>(1T8)c4 (-3T8)Bg3>>(-1T10)g3 
+15.(-3T9)d2d4 (2T9)Rc1d1 / (-3T9)Bf8d6 (2T9)c7c6 
+16.(-3T10)h3h4 (2T10)Rh1g1 / (-3T10)Bd6g3 (2T10)d5d4 
+17.(-3T11)a2a4 (2T11)Nf3d4 / (-3T11)b7>>(-2T11)b7 (2T11)Qd8d4 
+18.(0T12)Nb1>>(0T11)b3 (-4T11)Qd2b4 / (3T11)c6c5 (-4T11)Rd8d3 
+19.(-2T12)Nd2>>(-2T11)d4 (-5T9)Qd2c3 / (-5T9)Nc4e3 
+20.(-5T10)f2e3 / (-5T10)Qb6>>(-5T9)a5 
+21.(-5T11)Qc3g7 / (4T11)e5d4 (-5T11)Bf8g7 
+22.(-7T12)Nc8>>(-5T11)c8 (-6T11)f2g3 / (5T11)Ra8c8 (-6T11)Qd6g3 
+23.(1T12)c6>>(0T11)c6 / (6T11)b7c6 
+24.(6T12)Bf1>>(0T12)f7 (-3T12)Bc1>>(-3T10)e1 (-8T10)Rh1h2 / (-8T10)Nc4e3 (8T10)a7a5 
+25.(-8T11)f2e3 (8T11)Nb1a3 / (-8T11)Qb6e3 (8T11)c6c5 
+26.(3T12)Bc1>>(2T11)c1 / (9T11)Qd8a5
+)";
+
+namespace
+{
+
+constexpr int repetitions = 20;
+
+const char *name_of(mate_type mt)
+{
+    switch(mt)
+    {
+    case mate_type::NONE:
+        return "none";
+    case mate_type::CHECKMATE:
+        return "checkmate";
+    case mate_type::SOFTMATE:
+        return "softmate";
+    case mate_type::STALEMATE:
+        return "stalemate";
+    }
+    return "?";
+}
+
+template<typename F>
+void bench(const char *name, F f)
+{
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+    for(int i = 0; i < repetitions; i++)
+    {
+        f();
+    }
+    const double us = std::chrono::duration<double, std::micro>(clock::now() - start).count();
+    std::cout << "  " << name << ": " << us / repetitions << " us/op\n";
+}
+
+void run(const char *name, const std::string &pgn, mate_type expected, bool expected_softmate)
+{
+    const state s(*pgnparser(pgn).parse_game());
+    const mate_type mt = s.get_mate_type();
+    const bool softmate = s.is_softmate();
+    assert(mt == expected);
+    assert(softmate == expected_softmate);
+    std::cout << name << ": " << name_of(mt) << (softmate ? " (is_softmate)" : "") << "\n";
+    bench("get_mate_type", [&s]() { return s.get_mate_type(); });
+    bench("is_softmate", [&s]() { return s.is_softmate(); });
+}
+
+} /* anonymous namespace */
+
+int main()
+{
+    run("softmate.5dpgn", softmate_pgn, mate_type::CHECKMATE, true);
+    run("manyChecks.5dpgn", many_checks_pgn, mate_type::CHECKMATE, true);
+    std::cerr << "---= bench_mate_type.cpp: all passed =---" << std::endl;
+    return 0;
+}
@@ -13,5 +13,15 @@ int main()
     const std::optional<action> best_move = bot.find_best_move(1, std::nullopt, {});
     assert(best_move.has_value());
     assert(best_move->get_length() > 0);
+
+    // a seeded single-worker search is reproducible, and several workers
+    // share one search
+    flat_ucb_engine again(std::make_unique<stdio_handler>(), 1, 0);
+    again.set_position("startpos", "");
+    assert(again.find_best_move(1, std::nullopt, {}) == best_move);
+    flat_ucb_engine parallel(std::make_unique<stdio_handler>(), 1, 20);
+    parallel.set_position("startpos", "");
+    parallel.set_option("Threads", 4);
+    assert(parallel.find_best_move(6, std::nullopt, {}).has_value());
     return 0;
 }
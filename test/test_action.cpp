@@ -1,6 +1,9 @@
 #undef NDEBUG
 #include <cassert>
+#include <algorithm>
+#include <set>
 #include "core/action.h"
+#include "core/hypercuboid.h"
 #include "core/pgnparser.h"
 #include "core/state.h"
 
@@ -42,4 +45,48 @@ int main()
     assert(advanced.second == mate_type::NONE);
     assert(e4.pgn(standard, pgn_options::SHOW_MATE)
         == e4.pgn_advanced(standard, pgn_options::SHOW_MATE).first);
+
+    // the canonical hash ignores the order of the moves but not promotions
+    const moveseq two = {full_move("(0T1)e2e4"), full_move("(0T1)d2d4")};
+    const moveseq swapped = {two[1], two[0]};
+    assert(canonical_hash(two) == canonical_hash(swapped));
+    assert(canonical_hash(two) != canonical_hash(moveseq{two[0]}));
+    assert(action::from_moveseq(two, standard).canonical_hash() == canonical_hash(swapped));
+    assert(action::from_vector({ext_move("(0T0)e7e8N")}, standard).canonical_hash()
+        != canonical_hash(moveseq{full_move("(0T0)e7e8")}));
+    assert(action::from_moveseq(two, standard).same_moves(action::from_moveseq(swapped, standard)));
+
+    // equal positions hash equally however they were reached
+    const state reparsed(*pgnparser("[Board \"Standard\"]").parse_game());
+    assert(reparsed.hash() == standard.hash());
+    assert(after_e4->hash() != standard.hash());
+    assert(standard.can_apply(action::from_moveseq({full_move("(0T1)e2e4")}, standard))->hash() == after_e4->hash());
+
+    // the search emits every action once, already in the standard order
+    const auto branching_game = pgnparser(R"(
+[Board "Custom"]
+[Size "5x5"]
+[K4/4k/4r/5/5:0:1:w]
+[K4/4k/5/5/R4:-1:1:w]
+[3rk/5/K2r1/5/5:1:1:w]
+[4r/5/2k2/5/4K:2:1:w]
+
+1. (-1T1)Ka5b5 (0T1)Ka5a4 (1T1)Ka3a4 (2T1)Ke1d1 / (2T1)Re5d5 (1T1)Rd3d4 (0T1)Ke4e5 (-1T1)Ke4e5
+2. (-1T2)Kb5a5 (1T2)Ka4>(0T2)a5 (2T2)Kd1e1 / (2T2)Rd5d2 (1T2)Rd4d2 (0T2)Re3e1 (-1T2)Ke5d5
+)").parse_game();
+    const state branching(*branching_game);
+    auto [w, ss] = HC_info::build_HC(branching);
+    std::set<std::uint64_t> hashes;
+    for(const moveseq &mvs : w.search(ss))
+    {
+        const action act = action::from_moveseq(mvs, branching);
+        std::vector<full_move> sorted;
+        for(const ext_move &mv : act.get_moves())
+        {
+            sorted.push_back(mv.fm);
+        }
+        assert(sorted == mvs);
+        assert(hashes.insert(canonical_hash(mvs)).second);
+    }
+    assert(hashes.size() == 21);
 }
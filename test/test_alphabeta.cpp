@@ -0,0 +1,86 @@
+#undef NDEBUG
+#include <cassert>
+#include <memory>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+#include "alphabeta.h"
+
+class capture_io_handler : public io_handler
+{
+public:
+    std::vector<std::string> *lines;
+    explicit capture_io_handler(std::vector<std::string> *lines) : lines(lines) {}
+    std::string read_line() override { return {}; }
+    void write_line(const std::string &line) override { lines->push_back(line); }
+    bool is_open() override { return false; }
+};
+
+// the reported lines starting with `prefix`
+std::vector<std::string> reported(const std::vector<std::string> &lines, const std::string &prefix)
+{
+    std::vector<std::string> found;
+    for(const std::string &line : lines)
+    {
+        if(line.rfind("info " + prefix, 0) == 0)
+        {
+            found.push_back(line);
+        }
+    }
+    return found;
+}
+
+int main()
+{
+    // a mate in one is found at depth 2 and ends the deepening
+    {
+        std::vector<std::string> lines;
+        alphabeta_engine eng(std::make_unique<capture_io_handler>(&lines));
+        eng.set_position("size 4x4 odd fen [k3/1R2/K3/3R:0:1:w]", "");
+        const auto best = eng.find_best_move(6, std::nullopt, std::stop_token{});
+        assert(best.has_value());
+        const state &s = *eng.get_current_state();
+        assert(best->get_moves().size() == 1);
+        assert(best->get_moves()[0].lan(s) == "(0T1)d1d4");
+        const std::vector<std::string> depths = reported(lines, "alphabeta ");
+        assert(depths.size() == 2);
+        assert(depths[1].find(" score=" + std::to_string(alphabeta_engine::MATE_SCORE - 1)) != std::string::npos);
+        assert(reported(lines, "alphabeta_stats ").size() == 1);
+    }
+
+    // the search is deterministic, and a deeper search reuses the table
+    {
+        std::vector<std::string> lines;
+        alphabeta_engine first(std::make_unique<capture_io_handler>(&lines));
+        alphabeta_engine second(std::make_unique<capture_io_handler>(&lines));
+        first.set_position("startpos", "");
+        second.set_position("startpos", "");
+        const auto a = first.find_best_move(2, std::nullopt, std::stop_token{});
+        const auto b = second.find_best_move(2, std::nullopt, std::stop_token{});
+        assert(a.has_value() && a == b);
+        const std::vector<std::string> depths = reported(lines, "alphabeta ");
+        assert(depths.size() == 4);
+        assert(depths[1].find(" nodes=") != std::string::npos);
+        assert(depths[1].find(" pv ") != std::string::npos);
+
+        lines.clear();
+        assert(first.find_best_move(3, std::nullopt, std::stop_token{}).has_value());
+        const std::vector<std::string> stats = reported(lines, "alphabeta_stats ");
+        assert(stats.size() == 1);
+        const std::size_t hits = stats[0].find(" tt_hits=");
+        assert(hits != std::string::npos);
+        assert(std::stoul(stats[0].substr(hits + 9)) > 0);
+    }
+
+    // out of time before depth 1 completes, it still plays a legal action
+    {
+        std::vector<std::string> lines;
+        alphabeta_engine eng(std::make_unique<capture_io_handler>(&lines));
+        eng.set_position("startpos", "");
+        const auto best = eng.find_best_move(std::nullopt, 0, std::stop_token{});
+        assert(best.has_value());
+        assert(eng.get_current_state()->can_apply(*best).has_value());
+    }
+    return 0;
+}
@@ -1,7 +1,9 @@
 #undef NDEBUG
+#include <algorithm>
 #include <tuple>
 #include <ranges>
 #include <cassert>
+#include "action.h"
 #include "state.h"
 #include "pgnparser.h"
 #include "finetree.h"
@@ -29,6 +31,29 @@ fine_node<> *goto_next_nodal(fine_node<> *node)
     return node;
 }
 
+// canonical hashes of every action below `node`, sorted
+std::vector<std::uint64_t> all_actions(fine_node<> *node)
+{
+    std::vector<std::uint64_t> hashes;
+    for(index_t i : node->search())
+    {
+        (void)i;
+    }
+    for(fine_node<> *child : node->get_children())
+    {
+        if(child->is_ceiling())
+        {
+            hashes.push_back(canonical_hash(child->to_action()));
+        }
+        else
+        {
+            append_vectors(hashes, all_actions(child));
+        }
+    }
+    std::sort(hashes.begin(), hashes.end());
+    return hashes;
+}
+
 int main()
 {
     state s(*pgnparser(str).parse_game());
@@ -88,5 +113,13 @@ int main()
     }
     node = goto_next_nodal(node);
     print_range("Got action: ", node->to_action());
+
+    // a shuffled tree finds the same actions in another order, the same
+    // order for the same seed
+    auto natural = fine_node<>::make_root(s);
+    auto shuffled = fine_node<>::make_shuffled_root(s, 5u);
+    auto reshuffled = fine_node<>::make_shuffled_root(s, 5u);
+    assert(shuffled->search().first() == reshuffled->search().first());
+    assert(all_actions(shuffled.get()) == all_actions(natural.get()));
     return 0;
 }
@@ -1,8 +1,15 @@
 #undef NDEBUG
+#include <algorithm>
 #include <iostream>
 #include <cassert>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 #include "graph.h"
 #include "hypercuboid.h"
+#include "pgnparser.h"
 
 void test_graph()
 {
@@ -186,12 +193,166 @@ void test_hardcoded_graph()
     }
 }
 
+/* the matching covers `include` and only uses edges of g */
+bool is_valid_matching(const graph &g, const std::vector<index_t> &include, const graph::matching &m)
+{
+    std::vector<int> degree(64, 0);
+    for(const auto &[u, v] : m)
+    {
+        const auto ns = g.neighbors(u);
+        if(std::find(ns.begin(), ns.end(), v) == ns.end())
+        {
+            return false;
+        }
+        degree[u]++;
+        degree[v]++;
+    }
+    for(int d : degree)
+    {
+        if(d > 1) return false;
+    }
+    for(index_t n : include)
+    {
+        if(degree[n] != 1) return false;
+    }
+    return true;
+}
+
+void test_random_matchings()
+{
+    std::mt19937 rng(5);
+    std::bernoulli_distribution coin(0.2);
+    for(int round = 0; round < 200; round++)
+    {
+        graph g(64);
+        for(index_t u = 0; u < 64; u++)
+        {
+            for(index_t v = 0; v < u; v++)
+            {
+                if(coin(rng)) g.add_edge(u, v);
+            }
+        }
+        std::vector<index_t> include;
+        for(index_t u = 0; u < 64; u += 3)
+        {
+            include.push_back(u);
+        }
+        auto m = g.find_matching(include);
+        if(!m)
+        {
+            continue;
+        }
+        assert(is_valid_matching(g, include, *m));
+        // without one of its edges, any matching found is still valid
+        const auto [u, v] = (*m)[rng() % m->size()];
+        g.remove_edge(u, v);
+        if(auto rematched = g.find_matching(include))
+        {
+            assert(is_valid_matching(g, include, *rematched));
+        }
+    }
+}
+
+void test_search_space_serialization()
+{
+    HC hc {{{1,2}, {2,3,200}, {0,64,65}}};
+    search_space ss = hc.remove_point({1,2,0});
+    ss.push_back(HC{{integer_set{}, {7}}});
+    std::stringstream buffer;
+    ss.write(buffer);
+    const std::string bytes = buffer.str();
+    std::istringstream in(bytes);
+    search_space copy = search_space::read(in);
+    assert(copy.to_string() == ss.to_string());
+    assert(copy.volume() == ss.volume());
+
+    std::istringstream truncated(bytes.substr(0, bytes.size() - 1));
+    bool thrown = false;
+    try { search_space::read(truncated); }
+    catch(const std::runtime_error &) { thrown = true; }
+    assert(thrown);
+}
+
+const std::string number1_pgn = R"(
+[Board "Custom"]
+[Size "5x5"]
+[K4/4k/4r/5/5:0:1:w]
+[K4/4k/5/5/R4:-1:1:w]
+[3rk/5/K2r1/5/5:1:1:w]
+[4r/5/2k2/5/4K:2:1:w]
+
+1. (-1T1)Ka5b5 (0T1)Ka5a4 (1T1)Ka3a4 (2T1)Ke1d1 / (2T1)Re5d5 (1T1)Rd3d4 (0T1)Ke4e5 (-1T1)Ke4e5
+2. (-1T2)Kb5a5 (1T2)Ka4>(0T2)a5 (2T2)Kd1e1 / (2T2)Rd5d2 (1T2)Rd4d2 (0T2)Re3e1 (-1T2)Ke5d5
+)";
+
+void test_resumable_search()
+{
+    state s(*pgnparser(number1_pgn).parse_game());
+    auto [w, ss] = HC_info::build_HC(s);
+    std::vector<moveseq> expected;
+    for(moveseq mvs : w.search(ss))
+    {
+        expected.push_back(std::move(mvs));
+    }
+    assert(!expected.empty());
+
+    // stopping after every k actions and resuming from a saved copy of the
+    // space gives the same actions in the same order
+    for(std::size_t k = 1; k <= expected.size(); k++)
+    {
+        std::vector<moveseq> resumed;
+        search_space remaining = ss;
+        while(true)
+        {
+            std::size_t produced = 0;
+            for(moveseq mvs : w.resumable_search(remaining))
+            {
+                resumed.push_back(std::move(mvs));
+                if(++produced == k)
+                {
+                    break;
+                }
+            }
+            if(produced < k)
+            {
+                break;
+            }
+            std::stringstream buffer;
+            remaining.write(buffer);
+            remaining = search_space::read(buffer);
+        }
+        assert(resumed == expected);
+    }
+
+    // so does stopping from the checkpoint hook after every k candidates,
+    // whether or not an action was found in between
+    for(std::size_t k = 1; k <= 8; k++)
+    {
+        std::vector<moveseq> resumed;
+        search_space remaining = ss;
+        while(!remaining.empty())
+        {
+            std::size_t examined = 0;
+            for(moveseq mvs : w.resumable_search(remaining, [&]() { return examined++ < k; }))
+            {
+                resumed.push_back(std::move(mvs));
+            }
+            std::stringstream buffer;
+            remaining.write(buffer);
+            remaining = search_space::read(buffer);
+        }
+        assert(resumed == expected);
+    }
+    std::cout << "resumable search reproduced " << expected.size() << " actions\n";
+}
+
 int main()
 {
     test_graph();
     //test_discrete_graph();
     test_hc();
     test_backward_slice_removal();
+    test_random_matchings();
     //test_remove();
 //    HC h2 = {{{1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20}}};
 //    point b = {20};
@@ -199,6 +360,8 @@ int main()
 //    search_space ss3 = h2.remove_point(b);
 //    std::cout << ss3.to_string() << "\n";
     test_hardcoded_graph();
+    test_search_space_serialization();
+    test_resumable_search();
     std::cerr << "---= test_hcutils.cpp: all passed =---" << std::endl;
     return 0;
 }
@@ -0,0 +1,111 @@
+#undef NDEBUG
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "state.h"
+#include "hypercuboid.h"
+#include "history_ordering.h"
+#include "pgnparser.h"
+
+const std::string number1_pgn = R"(
+[Board "Custom"]
+[Size "5x5"]
+[K4/4k/4r/5/5:0:1:w]
+[K4/4k/5/5/R4:-1:1:w]
+[3rk/5/K2r1/5/5:1:1:w]
+[4r/5/2k2/5/4K:2:1:w]
+
+1. (-1T1)Ka5b5 (0T1)Ka5a4 (1T1)Ka3a4 (2T1)Ke1d1 / (2T1)Re5d5 (1T1)Rd3d4 (0T1)Ke4e5 (-1T1)Ke4e5
+2. (-1T2)Kb5a5 (1T2)Ka4>(0T2)a5 (2T2)Kd1e1 / (2T2)Rd5d2 (1T2)Rd4d2 (0T2)Re3e1 (-1T2)Ke5d5
+)";
+
+// forwards to another ordering and counts the rejected points it observes
+template<HC_ordering Order>
+struct counting_ordering
+{
+    Order order;
+    int *rejections;
+    void for_each(index_t n, const integer_set &s, auto &&f) const
+    {
+        order.for_each(n, s, f);
+    }
+    void observe(const point &p, const std::optional<slice> &problem) const
+    {
+        observe_point(order, p, problem);
+        if(problem)
+        {
+            (*rejections)++;
+        }
+    }
+};
+
+template<HC_ordering Order>
+int rejections_before_first(const HC_info &w, const search_space &ss, Order order)
+{
+    int rejections = 0;
+    auto first = w.search(ss, counting_ordering<Order>{std::move(order), &rejections}).first();
+    assert(first.has_value());
+    return rejections;
+}
+
+std::set<moveseq> all_actions(generator<moveseq> gen)
+{
+    std::set<moveseq> result;
+    for(moveseq mvs : gen)
+    {
+        std::sort(mvs.begin(), mvs.end());
+        result.insert(std::move(mvs));
+    }
+    return result;
+}
+
+int main()
+{
+    state s(*pgnparser(number1_pgn).parse_game());
+    auto [w, ss] = HC_info::build_HC(s);
+
+    // every axis is visited as a permutation of the allowed entries
+    semimove_history history;
+    history_HC_ordering plain(w, history);
+    for(index_t n = 0; n < w.dimension; n++)
+    {
+        std::vector<index_t> visited;
+        plain.for_each(n, w.universe[n], [&](index_t i) { visited.push_back(i); });
+        std::vector<index_t> expected(w.universe[n].begin(), w.universe[n].end());
+        std::sort(visited.begin(), visited.end());
+        assert(visited == expected);
+    }
+
+    // the same generator and table give the same ordering
+    std::mt19937 rng1(7), rng2(7);
+    history_HC_ordering random1(w, rng1, history), random2(w, rng2, history);
+    for(index_t n = 0; n < w.dimension; n++)
+    {
+        std::vector<index_t> a, b;
+        random1.for_each(n, w.universe[n], [&](index_t i) { a.push_back(i); });
+        random2.for_each(n, w.universe[n], [&](index_t i) { b.push_back(i); });
+        assert(a == b);
+    }
+
+    // the ordering never changes the set of legal actions, and it learns
+    const auto legal = all_actions(w.search(ss));
+    assert(all_actions(w.search(ss, history_HC_ordering(w, history))) == legal);
+    std::uint64_t observed = 0;
+    for(std::size_t f = 0; f < semimove_history::feature_count; f++)
+    {
+        observed += history.accepted[f] + history.rejected[f];
+    }
+    assert(observed > 0);
+
+    const int natural = rejections_before_first(w, ss, natural_HC_ordering{});
+    const int trained = rejections_before_first(w, ss, history_HC_ordering(w, history));
+    std::cout << legal.size() << " legal actions; problem slices before the first one: natural "
+              << natural << ", history " << trained << "\n";
+
+    std::cout << "---= test_history_ordering.cpp: all passed =---" << std::endl;
+    return 0;
+}
@@ -177,6 +177,65 @@ void test_policy_evaluates_final_rollout_state()
     assert(std::abs(result.score + std::tanh(1.0f)) < 1e-6f);
 }
 
+void test_evaluation_cutoffs()
+{
+    // with only the bias, every evaluation is tanh(1) for the player to move
+    linear_engine::weight_vector_t weights{};
+    weights[linear_engine::bias_offset] = 1.0f;
+
+    // a threshold of 0 truncates the rollout at its first evaluation
+    state truncated = standard_position();
+    std::mt19937 truncated_rng(5);
+    const linear_rollout_result fixed = linear_engine::evaluated_rollout(
+        truncated, 200, {2, 0.0f}, weights, {}, &truncated_rng);
+    assert(fixed.cut_off);
+    assert(fixed.rollout.termination == rollout_termination::ACTION_LIMIT);
+    assert(fixed.rollout.actions == 2);
+    assert(fixed.evaluations == 1);
+    assert(std::abs(std::abs(fixed.score) - std::tanh(1.0f)) < 1e-6f);
+
+    // an unreached threshold evaluates every interval and at the limit
+    state full = standard_position();
+    std::mt19937 full_rng(5);
+    const linear_rollout_result uncut = linear_engine::evaluated_rollout(
+        full, 6, {2, 0.9f}, weights, {}, &full_rng);
+    assert(!uncut.cut_off);
+    assert(uncut.rollout.actions == 6);
+    assert(uncut.evaluations == 3);
+    // the same seed plays the same actions
+    assert(uncut.rollout.first_action == fixed.rollout.first_action);
+
+    // a rollout ending on a decided position is scored by its result
+    multiverse_odd mate_multiverse({{0, 1, true, "k6R/1R6/K7/8/8/8/8/8"}});
+    state mated(mate_multiverse);
+    const linear_rollout_result win = linear_engine::evaluated_rollout(
+        mated, 0, {2, 0.0f}, weights);
+    assert(win.rollout.termination == rollout_termination::WINNER);
+    assert(win.score == WINNING_SCORE);
+    assert(win.evaluations == 0);
+    multiverse_odd stalemate_multiverse({{0, 1, true, "k7/2Q5/2K5/8/8/8/8/8"}});
+    state stalemated(stalemate_multiverse);
+    const linear_rollout_result draw = linear_engine::evaluated_rollout(
+        stalemated, 0, {2, 0.0f}, weights);
+    assert(draw.rollout.termination == rollout_termination::STALEMATE);
+    assert(draw.score == 0.0f);
+    // without cutoffs the final position is evaluated as before
+    state unchecked(mate_multiverse);
+    const linear_rollout_result evaluated = linear_engine::evaluated_rollout(
+        unchecked, 0, {0, 0.9f}, weights);
+    assert(evaluated.rollout.termination == rollout_termination::ACTION_LIMIT);
+    assert(evaluated.evaluations == 1);
+
+    // the engine takes both settings as options
+    test_linear_engine engine(std::make_unique<sink_io>(), std::nullopt, 200, weights);
+    engine.set_option("eval-interval", 3);
+    engine.set_option("eval-cutoff", 0);
+    std::mt19937 rng(5);
+    const default_policy_result result = engine.policy(standard_position(), &rng);
+    assert(result.termination == rollout_termination::ACTION_LIMIT);
+    assert(std::abs(std::abs(result.score) - std::tanh(1.0f)) < 1e-6f);
+}
+
 } /* anonymous namespace */
 
 int main()
@@ -187,5 +246,6 @@ int main()
     test_rollout_value_and_inplace_semantics();
     test_stalemate_rollout_termination();
     test_policy_evaluates_final_rollout_state();
+    test_evaluation_cutoffs();
     return 0;
 }
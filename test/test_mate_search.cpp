@@ -0,0 +1,46 @@
+#undef NDEBUG
+#include <cassert>
+#include <chrono>
+#include <stop_token>
+
+#include "mate_search.h"
+#include "pgnparser.h"
+
+int main()
+{
+    // a rook mates in one along the fourth rank
+    {
+        const state s = *pgnparser("[Board \"Custom\"]\n[Size \"4x4\"]\n[k3/1R2/K3/3R:0:1:w]\n").parse_game();
+        const mate_search_result result = find_mate(s, 1);
+        assert(result.status == mate_search_status::MATE);
+        assert(result.line.size() == 1);
+        assert(result.line[0].size() == 1);
+        assert(result.line[0][0].lan(s) == "(0T1)d1d4");
+        // a larger bound proves it too, even with a table of one entry
+        mate_search_options options;
+        options.memory_budget = 1;
+        const mate_search_result bounded = find_mate(s, 2, options);
+        assert(bounded.status == mate_search_status::MATE);
+        assert(bounded.table_clears > 0);
+        assert(bounded.line.size() % 2 == 1);
+    }
+
+    // no mate from the starting position
+    {
+        const state s = *pgnparser("[Board \"Standard\"]\n[Mode \"5D\"]\n").parse_game();
+        const mate_search_result result = find_mate(s, 1);
+        assert(result.status == mate_search_status::NO_MATE);
+        assert(result.line.empty());
+    }
+
+    // a stopped search leaves the question open
+    {
+        const state s = *pgnparser("[Board \"Standard\"]\n[Mode \"5D\"]\n").parse_game();
+        std::stop_source stop;
+        stop.request_stop();
+        mate_search_options options;
+        options.stop_token = stop.get_token();
+        assert(find_mate(s, 2, options).status == mate_search_status::UNKNOWN);
+    }
+    return 0;
+}
@@ -2,10 +2,95 @@
 #include <cassert>
 #include <cmath>
 #include <limits>
+#include <memory>
+#include <optional>
+#include <stop_token>
+#include <string>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "mcts.h"
 
+class capture_io_handler : public io_handler
+{
+public:
+    std::vector<std::string> *lines;
+    explicit capture_io_handler(std::vector<std::string> *lines) : lines(lines) {}
+    std::string read_line() override { return {}; }
+    void write_line(const std::string &line) override { lines->push_back(line); }
+    bool is_open() override { return false; }
+};
+
+// exposes the tree of the last search
+class tree_probe : public mcts_engine
+{
+public:
+    using mcts_engine::mcts_engine;
+    std::size_t root_children_in_tree() const
+    {
+        std::size_t included = 0;
+        for(const auto *child : root->get_children())
+        {
+            included += child->get_info().is_included;
+        }
+        return included;
+    }
+    std::size_t root_visits() const
+    {
+        return root->get_info().visits;
+    }
+};
+
+// the mcts_stats line reported by a fixed-budget search with `threads` workers
+template<typename Engine>
+std::string search_with_threads(int threads)
+{
+    std::vector<std::string> lines;
+    Engine eng(std::make_unique<capture_io_handler>(&lines), 7u, 20);
+    eng.set_position("startpos", "");
+    eng.set_option("Threads", threads);
+    const auto best = eng.find_best_move(6, std::nullopt, std::stop_token{});
+    assert(best.has_value());
+    for(const std::string &line : lines)
+    {
+        if(line.find("mcts_stats") != std::string::npos)
+        {
+            return line;
+        }
+    }
+    assert(false && "no mcts_stats line");
+    return {};
+}
+
+// the value of `key=` in the first reported line starting with `prefix`
+std::size_t reported_value(const std::vector<std::string> &lines, const std::string &prefix, const std::string &key)
+{
+    for(const std::string &line : lines)
+    {
+        if(line.rfind("info " + prefix, 0) == 0)
+        {
+            const std::size_t at = line.find(" " + key + "=");
+            assert(at != std::string::npos);
+            return std::stoul(line.substr(at + key.size() + 2));
+        }
+    }
+    assert(false && "line not reported");
+    return 0;
+}
+
+// the tokens of `position ... moves` that play `a` in `s` and submit it
+std::string played_line(const action &a, state s)
+{
+    std::string line;
+    for(const ext_move &mv : a.get_moves())
+    {
+        line += mv.lan(s) + ' ';
+        s.apply_move(mv.fm, mv.promote_to);
+    }
+    return line + "submit";
+}
+
 int main()
 {
     // Fine-tree child payloads are default-constructed and initialized when
@@ -45,5 +130,195 @@ int main()
            == std::numeric_limits<float>::infinity());
     assert(uct(0.0f, 0, 1, false)
            == -std::numeric_limits<float>::infinity());
+
+    // Moving a payload keeps its statistics, including pending virtual losses.
+    parent.virtual_loss = 2;
+    mcts_node_info moved(std::move(parent));
+    assert(moved.visits == 7 && moved.sum_reward == 42.0f && moved.virtual_loss == 2);
+
+    // A depth-limited search runs exactly its iteration budget (depth * 10)
+    // whether one or several workers share the tree, or every worker grows
+    // its own tree.
+    for(int threads : {1, 4})
+    {
+        for(const std::string &stats : {search_with_threads<mcts_engine>(threads),
+                                         search_with_threads<root_parallel_mcts_engine>(threads)})
+        {
+            assert(stats.find(" iterations=60 ") != std::string::npos);
+            assert(stats.find(" threads=" + std::to_string(threads) + " ") != std::string::npos);
+        }
+    }
+
+    // After the engine's own move is played, the next search continues from
+    // the subtree of that move instead of a fresh root.
+    {
+        std::vector<std::string> lines;
+        mcts_engine eng(std::make_unique<capture_io_handler>(&lines), 7u, 20);
+        eng.set_position("startpos", "");
+        auto best = eng.find_best_move(6, std::nullopt, std::stop_token{});
+        assert(best.has_value());
+        assert(reported_value(lines, "mcts_reuse", "visits") == 0);
+        const std::string line = played_line(*best, *eng.get_current_state());
+        eng.set_position("startpos", line);
+        lines.clear();
+        best = eng.find_best_move(6, std::nullopt, std::stop_token{});
+        assert(best.has_value());
+        assert(reported_value(lines, "mcts_reuse", "visits") > 0);
+        assert(reported_value(lines, "mcts_stats", "iterations") == 60);
+
+        // searching the same position again keeps the whole tree
+        lines.clear();
+        eng.find_best_move(6, std::nullopt, std::stop_token{});
+        assert(reported_value(lines, "mcts_reuse", "visits") >= 60);
+
+        // a position off the searched line starts over
+        eng.set_position("startpos", "");
+        lines.clear();
+        eng.find_best_move(6, std::nullopt, std::stop_token{});
+        assert(reported_value(lines, "mcts_reuse", "visits") == 0);
+    }
+
+    // A history-guided tree owns its history table, so it is reused too.
+    {
+        std::vector<std::string> lines;
+        mcts_engine eng(std::make_unique<capture_io_handler>(&lines), 7u, 20);
+        eng.set_option("history-ordering", true);
+        eng.set_position("startpos", "");
+        const auto best = eng.find_best_move(6, std::nullopt, std::stop_token{});
+        assert(best.has_value());
+        eng.set_position("startpos", played_line(*best, *eng.get_current_state()));
+        lines.clear();
+        eng.find_best_move(6, std::nullopt, std::stop_token{});
+        assert(reported_value(lines, "mcts_reuse", "visits") > 0);
+    }
+
+    // A tree over its memory budget releases cold nodal nodes but still
+    // runs its whole iteration budget. The transposition table counts
+    // towards the budget and gives back the entries no node uses.
+    {
+        std::vector<std::string> lines;
+        mcts_engine eng(std::make_unique<capture_io_handler>(&lines), 7u, 20);
+        eng.set_position("startpos", "");
+        eng.set_option("Hash", 1);
+        eng.set_option("rave-equivalence", 300);
+        const auto best = eng.find_best_move(60, std::nullopt, std::stop_token{});
+        assert(best.has_value());
+        assert(reported_value(lines, "mcts_stats", "iterations") == 600);
+        assert(reported_value(lines, "mcts_tree", "released_nodes") > 0);
+        assert(reported_value(lines, "mcts_tree", "nodal_nodes") > 0);
+        assert(reported_value(lines, "mcts_tree", "tt_entries") > 0);
+        assert(reported_value(lines, "mcts_tree", "evicted_entries") > 0);
+    }
+
+    // A mate in one is proven as soon as the mating action is searched: the
+    // search stops early and plays it, with or without RAVE.
+    for(const int rave_equivalence : {0, 300})
+    {
+        std::vector<std::string> lines;
+        mcts_engine eng(std::make_unique<capture_io_handler>(&lines), 7u, 20);
+        eng.set_position("size 4x4 odd fen [k3/1R2/K3/3R:0:1:w]", "");
+        eng.set_option("rave-equivalence", rave_equivalence);
+        const auto best = eng.find_best_move(100, std::nullopt, std::stop_token{});
+        assert(best.has_value());
+        assert(played_line(*best, *eng.get_current_state()) == "(0T1)d1d4 submit");
+        assert(reported_value(lines, "mcts_stats", "iterations") < 1000);
+        assert(reported_value(lines, "mcts_stats", "proven_nodes") > 0);
+    }
+
+    // Progressive widening keeps the root to k * N^alpha children: at most 8
+    // after 60 visits with k = 1 and alpha = 0.5, while the plain search takes
+    // every first semimove.
+    for(const bool shuffled : {false, true})
+    {
+        std::vector<std::string> lines;
+        tree_probe plain(std::make_unique<capture_io_handler>(&lines), 7u, 20);
+        tree_probe widened(std::make_unique<capture_io_handler>(&lines), 7u, 20);
+        for(tree_probe *eng : {&plain, &widened})
+        {
+            eng->set_position("startpos", "");
+            eng->set_option("widening-order", std::string(shuffled ? "random" : "search"));
+        }
+        widened.set_option("widening-k", 1);
+        widened.set_option("widening-alpha", 0.5);
+        assert(plain.find_best_move(6, std::nullopt, std::stop_token{}).has_value());
+        assert(widened.find_best_move(6, std::nullopt, std::stop_token{}).has_value());
+        assert(widened.root_children_in_tree() <= 8);
+        assert(plain.root_children_in_tree() > 8);
+    }
+
+    // RAVE statistics are recorded under the tree lock, so every worker
+    // still completes the shared iteration budget.
+    {
+        std::vector<std::string> lines;
+        mcts_engine eng(std::make_unique<capture_io_handler>(&lines), 7u, 20);
+        eng.set_position("startpos", "");
+        eng.set_option("Threads", 4);
+        eng.set_option("rave-equivalence", 300);
+        assert(eng.find_best_move(6, std::nullopt, std::stop_token{}).has_value());
+        assert(reported_value(lines, "mcts_stats", "iterations") == 60);
+    }
+
+    // every nodal node of a search is looked up in the transposition table
+    {
+        std::vector<std::string> lines;
+        mcts_engine eng(std::make_unique<capture_io_handler>(&lines), 7u, 20);
+        eng.set_position("startpos", "");
+        eng.find_best_move(20, std::nullopt, std::stop_token{});
+        const std::size_t lookups = reported_value(lines, "mcts_stats", "tt_lookups");
+        assert(lookups > 0);
+        assert(reported_value(lines, "mcts_stats", "tt_hits") <= lookups);
+    }
+
+    // progress is reported during the search at the "info-interval", and not
+    // at all when it is 0
+    for(const int interval : {1, 0})
+    {
+        std::vector<std::string> lines;
+        mcts_engine eng(std::make_unique<capture_io_handler>(&lines), 7u, 20);
+        eng.set_position("startpos", "");
+        eng.set_option("info-interval", interval);
+        assert(eng.find_best_move(50, std::nullopt, std::stop_token{}).has_value());
+        std::size_t progress_lines = 0;
+        for(const std::string &line : lines)
+        {
+            if(line.rfind("info mcts_progress ", 0) == 0)
+            {
+                assert(line.find(" pv") != std::string::npos);
+                progress_lines++;
+            }
+        }
+        assert((progress_lines > 0) == (interval != 0));
+        if(interval != 0)
+        {
+            assert(reported_value(lines, "mcts_progress", "iterations") <= 500);
+            assert(reported_value(lines, "mcts_progress", "hashfull") <= 1000);
+        }
+    }
+
+    // with RolloutsPerLeaf, every leaf counts as that many playouts, and a
+    // seeded single-threaded search plays the same move every time
+    {
+        std::vector<std::string> lines;
+        std::optional<action> first;
+        for(int run = 0; run < 2; run++)
+        {
+            lines.clear();
+            tree_probe eng(std::make_unique<capture_io_handler>(&lines), 7u, 20);
+            eng.set_position("startpos", "");
+            eng.set_option("RolloutsPerLeaf", 4);
+            const auto best = eng.find_best_move(6, std::nullopt, std::stop_token{});
+            assert(best.has_value());
+            if(first.has_value())
+            {
+                assert(*best == *first);
+            }
+            first = best;
+            const std::size_t iterations = reported_value(lines, "mcts_stats", "iterations");
+            const std::size_t rollouts = reported_value(lines, "mcts_stats", "rollouts");
+            assert(iterations == 60);
+            assert(rollouts <= 4 * iterations && rollouts > iterations);
+            assert(eng.root_visits() == rollouts + reported_value(lines, "mcts_stats", "terminal_tree_evaluations"));
+        }
+    }
     return 0;
 }
@@ -1,4 +1,5 @@
 #undef NDEBUG
+#include <algorithm>
 #include <cassert>
 #include <random>
 #include <vector>
@@ -45,4 +46,43 @@ int main()
         }
     }
     assert(filtered == expected);
+
+    // lazy_random_HC_ordering: a sparse subset visited first must follow the
+    // same permutation as the full axis drawn afterwards
+    integer_set wide;
+    for(index_t i = 0; i < 40; i++)
+    {
+        wide.insert(i);
+    }
+    HC big{wide, integer_set{1, 3, 5}};
+    const integer_set few{3, 17, 31};
+    std::mt19937 rng3(99);
+    std::mt19937 rng4(99);
+    std::vector<index_t> sparse_first, full_later;
+    {
+        lazy_random_HC_ordering lazy(big, rng3);
+        sparse_first = collect(lazy, 0, few);
+        full_later = collect(lazy, 0, big[0]);
+        std::vector<index_t> sorted = full_later;
+        std::sort(sorted.begin(), sorted.end());
+        assert((sorted == std::vector<index_t>(big[0].begin(), big[0].end())));
+        std::vector<index_t> few_in_order;
+        for(index_t i : full_later)
+        {
+            if(few.contains(i))
+            {
+                few_in_order.push_back(i);
+            }
+        }
+        assert(sparse_first == few_in_order);
+        // every element is placed now, so this takes the sparse path
+        assert(collect(lazy, 0, few) == sparse_first);
+    }
+    {
+        // same generator state and same calls; the buffers are reused
+        lazy_random_HC_ordering lazy(big, rng4);
+        assert(collect(lazy, 0, few) == sparse_first);
+        assert(collect(lazy, 0, big[0]) == full_later);
+        assert(collect(lazy, 1, big[1]).size() == 3);
+    }
 }
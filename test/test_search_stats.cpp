@@ -0,0 +1,57 @@
+#undef NDEBUG
+#include <cassert>
+#include <iostream>
+#include <string>
+#include "state.h"
+#include "hypercuboid.h"
+#include "pgnparser.h"
+#include "search_stats.h"
+
+const std::string number1_pgn = R"(
+[Board "Custom"]
+[Size "5x5"]
+[K4/4k/4r/5/5:0:1:w]
+[K4/4k/5/5/R4:-1:1:w]
+[3rk/5/K2r1/5/5:1:1:w]
+[4r/5/2k2/5/4K:2:1:w]
+
+1. (-1T1)Ka5b5 (0T1)Ka5a4 (1T1)Ka3a4 (2T1)Ke1d1 / (2T1)Re5d5 (1T1)Rd3d4 (0T1)Ke4e5 (-1T1)Ke4e5
+2. (-1T2)Kb5a5 (1T2)Ka4>(0T2)a5 (2T2)Kd1e1 / (2T2)Rd5d2 (1T2)Rd4d2 (0T2)Re3e1 (-1T2)Ke5d5
+)";
+
+int main()
+{
+    state s(*pgnparser(number1_pgn).parse_game());
+    auto [w, ss] = HC_info::build_HC(s);
+    search_stats::local().reset();
+    std::uint64_t count = 0;
+    for([[maybe_unused]] const moveseq &mvs : w.search(ss))
+    {
+        count++;
+    }
+    const search_stats &stats = search_stats::local();
+    std::cout << count << " actions; " << stats.to_string() << "\n";
+    if constexpr(search_stats::enabled)
+    {
+        std::uint64_t slices = 0;
+        for(std::uint64_t r : stats.rejections)
+        {
+            slices += r;
+        }
+        // every point taken is either rejected by one layer or yielded
+        assert(stats.points_taken == count + slices);
+        assert(stats.max_slice_axes <= static_cast<std::uint64_t>(w.dimension));
+        assert(stats.peak_search_space >= 1);
+
+        search_stats total = stats;
+        total += stats;
+        assert(total.points_taken == 2 * stats.points_taken);
+        assert(total.peak_search_space == stats.peak_search_space);
+    }
+    else
+    {
+        assert(stats.points_taken == 0 && stats.hc_splits == 0);
+    }
+    std::cout << "---= test_search_stats.cpp: all passed =---" << std::endl;
+    return 0;
+}
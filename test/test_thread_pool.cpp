@@ -0,0 +1,53 @@
+#undef NDEBUG
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <thread>
+#include <vector>
+#include "misc/thread_pool.h"
+
+int main()
+{
+    // every index runs exactly once, the first on the calling thread
+    thread_pool pool(3);
+    assert(pool.size() == 3);
+    std::vector<int> runs(16, 0);
+    std::thread::id first_thread;
+    pool.run(runs.size(), [&](std::size_t k)
+    {
+        runs[k]++;
+        if(k == 0)
+        {
+            first_thread = std::this_thread::get_id();
+        }
+    });
+    assert(first_thread == std::this_thread::get_id());
+    for(int count : runs)
+    {
+        assert(count == 1);
+    }
+
+    // the threads are kept between batches, and batches may overlap
+    std::atomic<std::size_t> total{0};
+    {
+        std::vector<std::jthread> callers;
+        for(int c = 0; c < 4; c++)
+        {
+            callers.emplace_back([&]()
+            {
+                for(int batch = 0; batch < 50; batch++)
+                {
+                    pool.run(4, [&](std::size_t) { total++; });
+                }
+            });
+        }
+    }
+    assert(total == 4 * 50 * 4);
+
+    // without threads, run() works through the batch itself
+    thread_pool empty(0);
+    std::size_t sum = 0;
+    empty.run(5, [&](std::size_t k) { sum += k; });
+    assert(sum == 10);
+    return 0;
+}
@@ -0,0 +1,45 @@
+#undef NDEBUG
+#include <cassert>
+#include <optional>
+#include "core/pgnparser.h"
+#include "core/state.h"
+#include "engine/time_control.h"
+
+int main()
+{
+    const state s(*pgnparser(R"(
+[Board "Standard - Turn Zero"]
+)").parse_game());
+    const auto [present, player] = s.get_present();
+    const int moves_to_go = estimated_moves_to_go(s);
+    assert(moves_to_go == clock_expected_game_turns - present);
+
+    // no clock for the side to move: no allocation
+    search_clock clock;
+    clock.time_ms[!player] = 60000;
+    assert(!allocate_move_time(clock, s, 0.0).has_value());
+
+    // an even share of the remaining time for each move left
+    clock.time_ms[player] = 60000;
+    assert(*allocate_move_time(clock, s, 0.0) == (60000 - clock_move_overhead_ms) / moves_to_go);
+
+    // movestogo replaces the estimate, and the increment is spent on top
+    clock.moves_to_go = 10;
+    clock.increment_ms[player] = 1000;
+    assert(*allocate_move_time(clock, s, 0.0) == (60000 - clock_move_overhead_ms) / 10 + 1000);
+
+    // a slow engine gets time for clock_min_iterations, within half the clock
+    clock.moves_to_go.reset();
+    clock.increment_ms[player] = 0;
+    assert(*allocate_move_time(clock, s, 20.0) == 5000);
+    assert(*allocate_move_time(clock, s, 1.0) == (60000 - clock_move_overhead_ms) / 2);
+
+    // an almost empty clock still allows a minimal search
+    clock.time_ms[player] = 10;
+    assert(*allocate_move_time(clock, s, 0.0) == 1);
+
+    assert(selection_decided(100, 40, 59.0));
+    assert(!selection_decided(100, 40, 60.0));
+    assert(!selection_decided(0, 0, 0.0));
+    return 0;
+}
@@ -223,6 +223,46 @@ int main()
     assert(recovery_io_ptr->output_lines[3].find("7P") != std::string::npos);
     assert(recovery_io_ptr->output_lines[4] == "bye");
 
+    // A pondering search ignores movetime until ponderhit, then stops on the
+    // clock of `go` without a stop command. Without a position the dummy
+    // answers nobestmove, which still comes before readyok.
+    auto ponder_io = std::make_unique<scripted_io_handler>(
+        std::vector<scripted_io_handler::scripted_line>{
+            {"go ponder movetime 20", 0},
+            {"ponderhit", 0},
+            {"isready", 0},
+            {"go ponder movetime 20", 2},
+            {"stop", 2},
+            {"isready", 2},
+            {"quit", 4}
+        });
+    auto *ponder_io_ptr = ponder_io.get();
+    dummy_engine ponder_eng(std::move(ponder_io));
+    ponder_eng.mainloop();
+
+    // a miss is answered with `stop`, which still ends the search
+    assert(ponder_io_ptr->output_lines.size() == 5);
+    assert(ponder_io_ptr->output_lines[0] == "nobestmove");
+    assert(ponder_io_ptr->output_lines[1] == "readyok");
+    assert(ponder_io_ptr->output_lines[2] == "nobestmove");
+    assert(ponder_io_ptr->output_lines[3] == "readyok");
+    assert(ponder_io_ptr->output_lines[4] == "bye");
+
+    // `go mate N ponder` also holds its answer back until ponderhit: quitting
+    // before it leaves the solved mate unanswered
+    auto mate_ponder_io = std::make_unique<scripted_io_handler>(
+        std::vector<scripted_io_handler::scripted_line>{
+            {"position size 4x4 odd fen [k3/1R2/K3/3R:0:1:w]", 0},
+            {"go mate 1 ponder", 0},
+            {"quit", 1}
+        });
+    auto *mate_ponder_io_ptr = mate_ponder_io.get();
+    dummy_engine mate_ponder_eng(std::move(mate_ponder_io));
+    mate_ponder_eng.mainloop();
+    assert(mate_ponder_io_ptr->output_lines.size() == 2);
+    assert(mate_ponder_io_ptr->output_lines[0].starts_with("info mate status=mate"));
+    assert(mate_ponder_io_ptr->output_lines[1] == "bye");
+
     std::cout << "All setoption tests passed!\n";
     return 0;
 }
@@ -8,11 +8,14 @@
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include "mcts.h"
 #include "linear.h"
 #include "monkey.h"
 #include "flat_ucb.h"
+#include "alphabeta.h"
 
 namespace
 {
@@ -20,14 +23,17 @@ struct command_line_options
 {
     std::optional<std::uint32_t> seed;
     int rollout_max_actions = default_mcts_rollout_max_actions;
+    // set before the main loop starts, like `setoption name <key> value <value>`
+    std::vector<std::pair<std::string, std::string>> engine_options;
 };
 
 void print_usage(std::ostream &out)
 {
-    out << "Usage: 5dchess <mcts|zero|linear|linear-trained|flat-uct|monkey> [options]\n"
+    out << "Usage: 5dchess <mcts|mcts-root-parallel|zero|linear|linear-trained|flat-uct|alphabeta|monkey> [options]\n"
         << "  -s, --seed <seed>               optional unsigned 32-bit random seed\n"
         << "  -r, --rollout-max-actions <n>   search rollout action limit (default "
         << default_mcts_rollout_max_actions << ")\n"
+        << "  -o, --option <key>=<value>      set an engine option at startup (repeatable)\n"
         << "  -h, --help                      display this help text and exit\n";
 }
 
@@ -67,7 +73,8 @@ command_line_options parse_options(
         }
         else if(option == "-r" || option == "--rollout-max-actions")
         {
-            if((engine_name != "mcts" && engine_name != "linear"
+            if((engine_name != "mcts" && engine_name != "mcts-root-parallel"
+                && engine_name != "linear"
                 && engine_name != "linear-trained"
                 && engine_name != "flat-uct")
                || rollout_limit_seen || ++i >= argc)
@@ -82,6 +89,20 @@ command_line_options parse_options(
             options.rollout_max_actions = static_cast<int>(parsed);
             rollout_limit_seen = true;
         }
+        else if(option == "-o" || option == "--option")
+        {
+            if(++i >= argc)
+            {
+                throw std::invalid_argument("invalid engine option");
+            }
+            const std::string assignment = argv[i];
+            const std::size_t equals = assignment.find('=');
+            if(equals == std::string::npos || equals == 0)
+            {
+                throw std::invalid_argument("invalid engine option");
+            }
+            options.engine_options.emplace_back(assignment.substr(0, equals), assignment.substr(equals + 1));
+        }
         else
         {
             throw std::invalid_argument("unknown option");
@@ -107,9 +128,11 @@ int main(int argc, const char *argv[])
     }
 
     const std::string engine_name = argv[1];
-    if(engine_name != "mcts" && engine_name != "zero" && engine_name != "linear"
+    if(engine_name != "mcts" && engine_name != "mcts-root-parallel"
+       && engine_name != "zero" && engine_name != "linear"
        && engine_name != "linear-trained"
-       && engine_name != "flat-uct" && engine_name != "monkey")
+       && engine_name != "flat-uct" && engine_name != "alphabeta"
+       && engine_name != "monkey")
     {
         std::cerr << "Unknown engine: " << engine_name << "\n";
         print_usage(std::cerr);
@@ -135,6 +158,12 @@ int main(int argc, const char *argv[])
             std::make_unique<stdio_handler>(), options.seed,
             options.rollout_max_actions);
     }
+    else if(engine_name == "mcts-root-parallel")
+    {
+        selected_engine = std::make_unique<root_parallel_mcts_engine>(
+            std::make_unique<stdio_handler>(), options.seed,
+            options.rollout_max_actions);
+    }
     else if(engine_name == "zero")
     {
         selected_engine = std::make_unique<zero_engine>(
@@ -155,12 +184,21 @@ int main(int argc, const char *argv[])
             std::make_unique<stdio_handler>(), options.seed,
             options.rollout_max_actions);
     }
+    else if(engine_name == "alphabeta")
+    {
+        selected_engine = std::make_unique<alphabeta_engine>(
+            std::make_unique<stdio_handler>());
+    }
     else if(engine_name == "monkey")
     {
         selected_engine = std::make_unique<monkey_engine>(
             std::make_unique<stdio_handler>(), options.seed);
     }
 
+    for(const auto &[key, value] : options.engine_options)
+    {
+        selected_engine->set_option(key, engine::parse_option_value(value));
+    }
     selected_engine->mainloop();
     return 0;
 }
@@ -2,11 +2,13 @@
 #include <exception>
 #include <iostream>
 #include <string_view>
+#include <vector>
 
 #include "position_tools.h"
 #include "replay_log.h"
 #include "run_perftest.h"
 #include "run_rollout.h"
+#include "search_stats.h"
 
 namespace
 {
@@ -24,10 +26,11 @@ struct command
 // under tools/; CMake discovers it automatically.
 constexpr std::array commands{
     command{"print", "", "print the final state of a 5DPGN game", run_print},
-    command{"count", "[policy] [max]", "count available actions", run_count},
-    command{"all", "[policy] [max]", "print available actions", run_all},
+    command{"count", "[policy] [max] [--checkpoint <file>]", "count available actions", run_count},
+    command{"all", "[policy] [max] [--checkpoint <file>]", "print available actions", run_all},
     command{"checkmate", "[policy]", "detect checkmate or stalemate", run_checkmate},
     command{"diff", "", "compare balanced and naive searches", run_diff},
+    command{"mate", "<N> [--hash <MB>]", "find a forced checkmate within N actions", run_mate},
     command{"perftest", "[policy]", "check every position in a 5DPGN game", run_perftest},
     command{"rollout", "[options]", "run random rollout simulations", run_rollout},
     command{"replay-log", "<log> [seed]", "replay and time a protocol failure log", replay_log},
@@ -47,8 +50,10 @@ void print_help()
     }
     std::cout
         << "\nRun '5dtools <command> --help' for detailed command usage.\n"
+        << "Add --stats to any command to print hypercuboid search statistics to stderr\n"
+        << "(requires a build configured with -DSEARCH_STATS=on).\n"
         << "\nSearch policies: balanced, naive, stable, iterative, mixed\n"
-        << "The print, count, all, checkmate, diff, and perftest commands read 5DPGN from stdin.\n";
+        << "The print, count, all, checkmate, diff, mate, and perftest commands read 5DPGN from stdin.\n";
 }
 }
 
@@ -73,13 +78,41 @@ int main(int argc, const char *argv[])
         return 0;
     }
 
+    // --stats is accepted by every command, so strip it before dispatching
+    std::vector<const char *> args;
+    bool print_stats = false;
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::string_view(argv[i]) == "--stats")
+        {
+            print_stats = true;
+        }
+        else
+        {
+            args.push_back(argv[i]);
+        }
+    }
+
     for(const command &entry : commands)
     {
         if(entry.name == requested)
         {
             try
             {
-                return entry.run(argc - 1, argv + 1);
+                search_stats::local().reset();
+                const int status = entry.run(static_cast<int>(args.size()), args.data());
+                if(print_stats)
+                {
+                    if constexpr(search_stats::enabled)
+                    {
+                        std::cerr << "search_stats " << search_stats::local().to_string() << '\n';
+                    }
+                    else
+                    {
+                        std::cerr << "search_stats unavailable: configure with -DSEARCH_STATS=on\n";
+                    }
+                }
+                return status;
             }
             catch(const std::exception &error)
             {
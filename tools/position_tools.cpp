@@ -8,7 +8,9 @@
 #include <string>
 #include <string_view>
 #include <tuple>
+#include <vector>
 
+#include "mate_search.h"
 #include "pgnparser.h"
 #include "search_tools.h"
 
@@ -83,78 +85,138 @@ int with_position(Function function)
     {
         return exit_code;
     }
-    function(*position->value);
+    try
+    {
+        function(*position->value);
+    }
+    catch(const std::runtime_error &error)
+    {
+        std::cerr << "Runtime error: " << error.what() << '\n';
+        return 1;
+    }
     return 0;
 }
-}
 
-int run_print(int argc, const char *argv[])
+constexpr std::string_view enumeration_arguments =
+    "[policy] [max] [--checkpoint <file> [--output <file>] [--interval <seconds>]]";
+constexpr std::string_view checkpoint_help =
+    "  --checkpoint <file>   save progress to <file> and resume from it if it exists\n"
+    "                        (balanced policy only; max counts the actions of all\n"
+    "                        runs, 0 for no limit)\n"
+    "  --output <file>       write actions to <file> so a resumed run repeats none\n"
+    "  --interval <seconds>  time between checkpoints (default: 60)\n";
+
+/* remove the checkpoint options from args; false if they are malformed */
+bool extract_checkpoint_args(std::vector<const char *> &args, std::optional<checkpoint_options> &checkpoint)
 {
-    if(help_requested(argc, argv))
+    std::vector<const char *> rest;
+    std::optional<std::string> path, output;
+    std::optional<int> interval;
+    for(std::size_t i = 0; i < args.size(); i++)
     {
-        print_position_help(std::cout, "print", "", "Print the final state of a 5DPGN game.");
-        return 0;
+        const std::string_view arg = args[i];
+        if(arg != "--checkpoint" && arg != "--output" && arg != "--interval")
+        {
+            rest.push_back(args[i]);
+            continue;
+        }
+        if(i + 1 == args.size())
+        {
+            return false;
+        }
+        const std::string value = args[++i];
+        if(arg == "--checkpoint") path = value;
+        else if(arg == "--output") output = value;
+        else
+        {
+            try { interval = std::stoi(value); }
+            catch(const std::exception &) { return false; }
+            if(*interval <= 0) return false;
+        }
     }
-    if(!validate_arguments(argc, 1, "print", "", "Print the final state of a 5DPGN game.")) return 2;
-    return with_position([](const state &s) { std::cout << s.to_string(); });
+    if(!path)
+    {
+        if(output || interval) return false;
+    }
+    else
+    {
+        checkpoint = checkpoint_options{*path, output, interval.value_or(60)};
+    }
+    args = std::move(rest);
+    return true;
 }
 
-int run_count(int argc, const char *argv[])
+template<bool PRINT>
+int run_enumeration(int argc, const char *argv[], std::string_view command, std::string_view description)
 {
     if(help_requested(argc, argv))
     {
-        print_position_help(std::cout, "count", "[policy] [max]", "Count available actions (default max: 10000).");
+        print_position_help(std::cout, command, enumeration_arguments, description);
+        std::cout << checkpoint_help;
         return 0;
     }
-    if(!validate_arguments(argc, 3, "count", "[policy] [max]", "Count available actions (default max: 10000).")) return 2;
+    std::vector<const char *> args(argv, argv + argc);
+    std::optional<checkpoint_options> checkpoint;
+    if(!extract_checkpoint_args(args, checkpoint))
+    {
+        std::cerr << "Error: invalid checkpoint arguments\n";
+        print_position_help(std::cerr, command, enumeration_arguments, description);
+        std::cerr << checkpoint_help;
+        return 2;
+    }
+    const int count = static_cast<int>(args.size());
+    if(!validate_arguments(count, 3, command, enumeration_arguments, description)) return 2;
     search_mode mode;
     int max;
-    try { std::tie(mode, max) = parse_search_args(argc, argv); }
+    try { std::tie(mode, max) = parse_search_args(count, args.data()); }
     catch(const std::exception &)
     {
         std::cerr << "Error: invalid search arguments\n";
-        print_position_help(std::cerr, "count", "[policy] [max]", "Count available actions (default max: 10000).");
+        print_position_help(std::cerr, command, enumeration_arguments, description);
+        return 2;
+    }
+    if(checkpoint && mode != search_mode::balanced)
+    {
+        std::cerr << "Error: --checkpoint requires the balanced policy\n";
         return 2;
     }
     return with_position([&](state s) {
+        if(checkpoint)
+        {
+            count_checkpointed<PRINT>(s, max, *checkpoint);
+            return;
+        }
         switch(mode)
         {
-            case search_mode::balanced: count_balanced(s, max); break;
-            case search_mode::naive: count_naive(s, max); break;
-            case search_mode::stable: count_stable(s, max); break;
-            case search_mode::iterative: count_iterative(s, max); break;
-            case search_mode::mixed: count_mixed(s, max); break;
+            case search_mode::balanced: count_balanced<PRINT>(s, max); break;
+            case search_mode::naive: count_naive<PRINT>(s, max); break;
+            case search_mode::stable: count_stable<PRINT>(s, max); break;
+            case search_mode::iterative: count_iterative<PRINT>(s, max); break;
+            case search_mode::mixed: count_mixed<PRINT>(s, max); break;
         }
     });
 }
+}
 
-int run_all(int argc, const char *argv[])
+int run_print(int argc, const char *argv[])
 {
     if(help_requested(argc, argv))
     {
-        print_position_help(std::cout, "all", "[policy] [max]", "Print available actions (default max: 10000).");
+        print_position_help(std::cout, "print", "", "Print the final state of a 5DPGN game.");
         return 0;
     }
-    if(!validate_arguments(argc, 3, "all", "[policy] [max]", "Print available actions (default max: 10000).")) return 2;
-    search_mode mode;
-    int max;
-    try { std::tie(mode, max) = parse_search_args(argc, argv); }
-    catch(const std::exception &)
-    {
-        std::cerr << "Error: invalid search arguments\n";
-        print_position_help(std::cerr, "all", "[policy] [max]", "Print available actions (default max: 10000).");
-        return 2;
-    }
-    return with_position([&](state s) {
-        switch(mode)
-        {
-            case search_mode::balanced: count_balanced<true>(s, max); break;
-            case search_mode::naive: count_naive<true>(s, max); break;
-            case search_mode::stable: count_stable<true>(s, max); break;
-            case search_mode::iterative: count_iterative<true>(s, max); break;
-            case search_mode::mixed: count_mixed<true>(s, max); break;
-        }
-    });
+    if(!validate_arguments(argc, 1, "print", "", "Print the final state of a 5DPGN game.")) return 2;
+    return with_position([](const state &s) { std::cout << s.to_string(); });
+}
+
+int run_count(int argc, const char *argv[])
+{
+    return run_enumeration<false>(argc, argv, "count", "Count available actions (default max: 10000).");
+}
+
+int run_all(int argc, const char *argv[])
+{
+    return run_enumeration<true>(argc, argv, "all", "Print available actions (default max: 10000).");
 }
 
 int run_checkmate(int argc, const char *argv[])
@@ -209,3 +271,76 @@ int run_diff(int argc, const char *argv[])
     if(!validate_arguments(argc, 1, "diff", "", "Compare balanced and naive search results.")) return 2;
     return with_position([](state s) { diff(s); });
 }
+
+int run_mate(int argc, const char *argv[])
+{
+    constexpr std::string_view arguments = "<N> [--hash <MB>]";
+    constexpr std::string_view description =
+        "Find a checkmate the player to move can force within N of their actions.";
+    if(help_requested(argc, argv))
+    {
+        print_position_help(std::cout, "mate", arguments, description);
+        std::cout << "  --hash <MB>  memory for the proof table (default: "
+                  << (default_mate_search_memory >> 20) << ")\n";
+        return 0;
+    }
+    int max_actions = 0;
+    mate_search_options options;
+    try
+    {
+        if(argc != 2 && !(argc == 4 && std::string_view(argv[2]) == "--hash"))
+        {
+            throw std::invalid_argument("arguments");
+        }
+        max_actions = std::stoi(argv[1]);
+        if(argc == 4)
+        {
+            const int mb = std::stoi(argv[3]);
+            if(mb <= 0)
+            {
+                throw std::out_of_range("hash");
+            }
+            options.memory_budget = static_cast<std::size_t>(mb) << 20;
+        }
+        if(max_actions <= 0)
+        {
+            throw std::out_of_range("N");
+        }
+    }
+    catch(const std::exception &)
+    {
+        std::cerr << "Error: invalid mate arguments\n";
+        print_position_help(std::cerr, "mate", arguments, description);
+        return 2;
+    }
+    return with_position([&](const state &s) {
+        const mate_search_result result = find_mate(s, max_actions, options);
+        if(result.status == mate_search_status::MATE)
+        {
+            std::ostringstream line;
+            state position = s;
+            for(std::size_t i = 0; i < result.line.size(); i++)
+            {
+                const action act = action::from_moveseq(result.line[i], position);
+                line << (i == 0 ? " " : " / ") << act.pgn(position);
+                position = *position.can_apply(act);
+            }
+            // a line that does not end in checkmate shows only the bound
+            if(position.get_mate_type() == mate_type::CHECKMATE)
+            {
+                std::cout << "Mate in " << (result.line.size() + 1) / 2 << ':' << line.str();
+            }
+            else
+            {
+                std::cout << "Mate within " << max_actions << ':' << line.str();
+            }
+        }
+        else
+        {
+            std::cout << "No mate in " << max_actions;
+        }
+        std::cout << "\nnodes=" << result.nodes
+                  << " table_entries=" << result.table_entries
+                  << " table_clears=" << result.table_clears << '\n';
+    });
+}
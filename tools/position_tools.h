@@ -6,5 +6,6 @@ int run_count(int argc, const char *argv[]);
 int run_all(int argc, const char *argv[]);
 int run_checkmate(int argc, const char *argv[]);
 int run_diff(int argc, const char *argv[]);
+int run_mate(int argc, const char *argv[]);
 
 #endif /* POSITION_TOOLS_H */
@@ -1,8 +1,12 @@
 #include "state.h"
+#include "linear.h"
 #include "pgnparser.h"
 #include "rollout.h"
 #include "run_rollout.h"
+#include <cmath>
+#include <cstdint>
 #include <optional>
+#include <random>
 #include <string>
 #include <iostream>
 #include <iomanip>
@@ -10,11 +14,102 @@
 #include <cstring>
 #include <sstream>
 #include <stdexcept>
+#include <vector>
 
 constexpr int MAX_ACTIONS = 200;
 
 constexpr int SIMULATION_NUM = 100;
 
+namespace
+{
+int sign(float value)
+{
+    return (value > 0.0f) - (value < 0.0f);
+}
+
+/*
+ Plays every simulation twice from the same seed, once to the action limit
+ and once with the evaluation cutoffs of the Linear engine, and compares
+ their speed and scores. The cut rollouts follow the full ones until they
+ stop, so their scores estimate the full results.
+ */
+void compare_cutoffs(const state &s, int max_actions, int simulation_num, rollout_sampler sampler,
+                     const char *sampler_name, const linear_cutoff_options &cutoff, bool csv_output)
+{
+    using clock = std::chrono::steady_clock;
+    const linear_engine::weight_vector_t weights = linear_engine::default_weights();
+    const std::uint32_t base_seed = std::random_device{}();
+    const linear_cutoff_options full{0, default_linear_eval_cutoff};
+    clock::duration full_duration{};
+    clock::duration cut_duration{};
+    std::size_t full_actions = 0;
+    std::size_t cut_actions = 0;
+    std::size_t cut_off = 0;
+    std::size_t evaluations = 0;
+    std::size_t same_sign = 0;
+    double sum_abs_difference = 0.0;
+    for(int i = 0; i < simulation_num; i++)
+    {
+        state full_position = s;
+        std::mt19937 full_rng(base_seed + static_cast<std::uint32_t>(i));
+        auto start = clock::now();
+        const linear_rollout_result full_result = linear_engine::evaluated_rollout(
+            full_position, max_actions, full, weights, {}, &full_rng, sampler);
+        const clock::duration full_time = clock::now() - start;
+
+        state cut_position = s;
+        std::mt19937 cut_rng(base_seed + static_cast<std::uint32_t>(i));
+        start = clock::now();
+        const linear_rollout_result cut_result = linear_engine::evaluated_rollout(
+            cut_position, max_actions, cutoff, weights, {}, &cut_rng, sampler);
+        const clock::duration cut_time = clock::now() - start;
+
+        full_duration += full_time;
+        cut_duration += cut_time;
+        full_actions += full_result.rollout.actions;
+        cut_actions += cut_result.rollout.actions;
+        cut_off += cut_result.cut_off;
+        evaluations += cut_result.evaluations;
+        same_sign += sign(full_result.score) == sign(cut_result.score);
+        sum_abs_difference += std::abs(full_result.score - cut_result.score);
+        if(csv_output)
+        {
+            std::cout << (i + 1) << ',' << full_result.score << ','
+                      << std::chrono::duration<double, std::milli>(full_time).count() << ','
+                      << cut_result.score << ','
+                      << std::chrono::duration<double, std::milli>(cut_time).count() << ','
+                      << sampler_name << '\n';
+        }
+        else
+        {
+            std::cout << "\rSimulation " << (i + 1) << "/" << simulation_num << "   ";
+            std::cout.flush();
+        }
+    }
+    if(csv_output)
+    {
+        return;
+    }
+    const double full_ms = std::chrono::duration<double, std::milli>(full_duration).count();
+    const double cut_ms = std::chrono::duration<double, std::milli>(cut_duration).count();
+    const auto per_second = [](double count, double ms) { return ms > 0.0 ? count * 1000.0 / ms : 0.0; };
+    std::cout << "\nSampler: " << sampler_name << "\n";
+    std::cout << "Full rollouts: " << per_second(simulation_num, full_ms) << " rollouts/s, "
+              << static_cast<double>(full_actions) / simulation_num << " actions each\n";
+    std::cout << "Cutoff rollouts (eval every " << cutoff.interval << " actions, cutoff " << cutoff.threshold << "): "
+              << per_second(simulation_num, cut_ms) << " rollouts/s, "
+              << static_cast<double>(cut_actions) / simulation_num << " actions each, "
+              << static_cast<double>(evaluations) / simulation_num << " evaluations each, "
+              << std::setprecision(1) << (cut_off * 100.0) / simulation_num << "% cut off\n";
+    std::cout << std::setprecision(2)
+              << "Speedup: " << (cut_ms > 0.0 ? full_ms / cut_ms : 0.0) << "x; "
+              << "agreement with full rollouts: " << std::setprecision(1) << (same_sign * 100.0) / simulation_num
+              << "% same sign, mean |score difference| " << std::setprecision(3)
+              << sum_abs_difference / simulation_num << "\n";
+    std::cout << std::setprecision(2);
+}
+} /* anonymous namespace */
+
 int run_rollout(int argc, const char *argv[])
 {
     const std::string default_pgn = //R"([Board "Standard - Turn Zero"])";
@@ -52,21 +147,29 @@ int run_rollout(int argc, const char *argv[])
     std::string pgn = default_pgn;
     int max_actions = MAX_ACTIONS;
     int simulation_num = SIMULATION_NUM;
-    int white_wins = 0;
-    int black_wins = 0;
-    int no_winner = 0;
     using clock = std::chrono::steady_clock;
-    clock::duration total_simulation_duration{};
+    std::vector<rollout_sampler> samplers = {rollout_sampler::ORDERED_SEARCH};
     bool csv_output = false;
     bool show_help = false;
     bool read_pgn_from_stdin = false;
+    std::optional<linear_cutoff_options> cutoff;
     auto print_help = [&](std::ostream &out = std::cout) {
         out << "Usage: 5dtools rollout [OPTIONS]\n"
                   << "  -m, --max-actions <n>  limit exploration depth per simulation (default " << MAX_ACTIONS << ")\n"
                   << "  -s, --simulations <n>  number of simulations to run (default " << SIMULATION_NUM << ")\n"
                   << "  -i                     read PGN from stdin until EOF (overrides default position)\n"
-                  << "  -csv                   emit CSV with columns simulation,winner,time_ms\n"
-                  << "                         (time_ms is the duration of each simulation in milliseconds)\n"
+                  << "  --sampler <name>       search (default), history or both; both runs every\n"
+                  << "                         simulation count once with search and history, and the\n"
+                  << "                         speeds are compared\n"
+                  << "  --eval-interval <k>    compare full rollouts scored by the Linear evaluation with\n"
+                  << "                         rollouts evaluated every k actions from the same seeds\n"
+                  << "  --eval-cutoff <t>      end a compared rollout once |evaluation| >= t (default "
+                  << default_linear_eval_cutoff << ";\n"
+                  << "                         0 plays fixed-length rollouts of k actions)\n"
+                  << "  -csv                   emit CSV with columns simulation,winner,time_ms,sampler\n"
+                  << "                         (time_ms is the duration of each simulation in milliseconds;\n"
+                  << "                         with --eval-interval: simulation,full_score,full_ms,\n"
+                  << "                         cutoff_score,cutoff_ms,sampler)\n"
                   << "  -h, --help             display this help text and exit\n";
     };
     for(int arg = 1; arg < argc; arg++)
@@ -133,11 +236,83 @@ int run_rollout(int argc, const char *argv[])
             }
             continue;
         }
+        if(std::strcmp(argv[arg], "--eval-interval") == 0 || std::strcmp(argv[arg], "--eval-cutoff") == 0)
+        {
+            if(++arg >= argc)
+            {
+                std::cerr << "Error: missing argument for " << argv[arg - 1] << "\n";
+                print_help(std::cerr);
+                return 2;
+            }
+            if(!cutoff.has_value())
+            {
+                cutoff.emplace();
+            }
+            const bool interval = std::strcmp(argv[arg - 1], "--eval-interval") == 0;
+            try
+            {
+                size_t consumed = 0;
+                if(interval)
+                {
+                    const int parsed = std::stoi(argv[arg], &consumed);
+                    if(consumed != std::strlen(argv[arg]) || parsed <= 0)
+                    {
+                        throw std::invalid_argument("non-positive");
+                    }
+                    cutoff->interval = parsed;
+                }
+                else
+                {
+                    const float parsed = std::stof(argv[arg], &consumed);
+                    if(consumed != std::strlen(argv[arg]) || parsed < 0.0f)
+                    {
+                        throw std::invalid_argument("negative");
+                    }
+                    cutoff->threshold = parsed;
+                }
+            }
+            catch(const std::exception &)
+            {
+                std::cerr << "Error: invalid number for " << argv[arg - 1] << ": " << argv[arg] << "\n";
+                print_help(std::cerr);
+                return 2;
+            }
+            continue;
+        }
         if(std::strcmp(argv[arg], "-i") == 0)
         {
             read_pgn_from_stdin = true;
             continue;
         }
+        if(std::strcmp(argv[arg], "--sampler") == 0)
+        {
+            if(++arg >= argc)
+            {
+                std::cerr << "Error: missing argument for " << argv[arg - 1] << "\n";
+                print_help(std::cerr);
+                return 2;
+            }
+            const std::string name = argv[arg];
+            if(name == "search")
+            {
+                samplers = {rollout_sampler::ORDERED_SEARCH};
+            }
+            else if(name == "history")
+            {
+                samplers = {rollout_sampler::HISTORY_SEARCH};
+            }
+            else if(name == "both")
+            {
+                samplers = {rollout_sampler::ORDERED_SEARCH, rollout_sampler::HISTORY_SEARCH};
+            }
+            else
+            {
+                std::cerr << "Error: unknown sampler: " << name << "\n";
+                print_help(std::cerr);
+                return 2;
+            }
+            continue;
+        }
         std::cerr << "Error: unknown option: " << argv[arg] << "\n";
         print_help(std::cerr);
         return 2;
@@ -147,6 +322,12 @@ int run_rollout(int argc, const char *argv[])
         print_help();
         return 0;
     }
+    if(cutoff.has_value() && cutoff->interval == 0)
+    {
+        std::cerr << "Error: --eval-cutoff needs --eval-interval\n";
+        print_help(std::cerr);
+        return 2;
+    }
     if(read_pgn_from_stdin)
     {
         std::ostringstream buffer;
@@ -172,59 +353,79 @@ int run_rollout(int argc, const char *argv[])
     state &s = *parsed_state;
     if(csv_output)
     {
-        std::cout << "simulation,winner,time_ms\n";
+        std::cout << (cutoff.has_value() ? "simulation,full_score,full_ms,cutoff_score,cutoff_ms,sampler\n"
+                                         : "simulation,winner,time_ms,sampler\n");
     }
     std::cout << std::fixed << std::setprecision(2);
-    for(int i = 0; i < simulation_num; i++)
+    for(rollout_sampler sampler : samplers)
     {
-        auto start = clock::now();
-        const std::optional<bool> winner = rollout(s, max_actions);
-        auto duration = clock::now() - start;
-        total_simulation_duration += duration;
-        double duration_ms = std::chrono::duration<double, std::milli>(duration).count();
-        if(csv_output)
-        {
-            std::cout << (i + 1) << ','
-                      << (winner.has_value() ? (*winner ? "black" : "white") : "none") << ','
-                      << duration_ms << '\n';
-        }
-        else
+        const char *sampler_name = sampler == rollout_sampler::HISTORY_SEARCH ? "history" : "search";
+        if(cutoff.has_value())
         {
-            std::cout << "\rSimulation " << (i + 1) << "/" << simulation_num
-                      << " (" << duration_ms
-                      << " ms)   ";
-            std::cout.flush();
+            compare_cutoffs(s, max_actions, simulation_num, sampler, sampler_name, *cutoff, csv_output);
+            continue;
         }
-        if(!winner.has_value())
+        int white_wins = 0;
+        int black_wins = 0;
+        int no_winner = 0;
+        std::size_t total_actions = 0;
+        clock::duration total_simulation_duration{};
+        for(int i = 0; i < simulation_num; i++)
         {
-            ++no_winner;
+            auto start = clock::now();
+            const rollout_result result = rollout_detailed(s, max_actions, {}, nullptr, sampler);
+            const std::optional<bool> winner = result.winner;
+            auto duration = clock::now() - start;
+            total_simulation_duration += duration;
+            total_actions += result.actions;
+            double duration_ms = std::chrono::duration<double, std::milli>(duration).count();
+            if(csv_output)
+            {
+                std::cout << (i + 1) << ','
+                          << (winner.has_value() ? (*winner ? "black" : "white") : "none") << ','
+                          << duration_ms << ',' << sampler_name << '\n';
+            }
+            else
+            {
+                std::cout << "\rSimulation " << (i + 1) << "/" << simulation_num
+                          << " (" << duration_ms
+                          << " ms)   ";
+                std::cout.flush();
+            }
+            if(!winner.has_value())
+            {
+                ++no_winner;
+            }
+            else if(*winner)
+            {
+                ++black_wins;
+            }
+            else
+            {
+                ++white_wins;
+            }
         }
-        else if(*winner)
+        if(csv_output)
         {
-            ++black_wins;
+            continue;
         }
-        else
+
+        std::cout << "\n";
+        const auto percent = [total = static_cast<double>(simulation_num)](int count)
         {
-            ++white_wins;
-        }
+            return (count * 100.0) / total;
+        };
+        std::cout << "Sampler: " << sampler_name << "\n";
+        std::cout << std::setprecision(1);
+        std::cout << "Outcome summary: white=" << percent(white_wins)
+                  << "%, black=" << percent(black_wins)
+                  << "%, none=" << percent(no_winner) << "%\n";
+        double total_simulation_ms = std::chrono::duration<double, std::milli>(total_simulation_duration).count();
+        double avg_simulation_ms = total_simulation_ms / simulation_num;
+        std::cout << std::setprecision(2);
+        std::cout << "Average simulation time: " << avg_simulation_ms << " ms\n";
+        std::cout << "Rollouts per second: " << (total_simulation_ms > 0.0 ? simulation_num * 1000.0 / total_simulation_ms : 0.0)
+                  << ", actions per second: " << (total_simulation_ms > 0.0 ? total_actions * 1000.0 / total_simulation_ms : 0.0) << "\n";
     }
-    if(csv_output)
-    {
-        return 0;
-    }
-
-    std::cout << "\n";
-    const auto percent = [total = static_cast<double>(simulation_num)](int count)
-    {
-        return (count * 100.0) / total;
-    };
-    std::cout << std::setprecision(1);
-    std::cout << "Outcome summary: white=" << percent(white_wins)
-              << "%, black=" << percent(black_wins)
-              << "%, none=" << percent(no_winner) << "%\n";
-    double total_simulation_ms = std::chrono::duration<double, std::milli>(total_simulation_duration).count();
-    double avg_simulation_ms = total_simulation_ms / simulation_num;
-    std::cout << std::setprecision(2);
-    std::cout << "Average simulation time: " << avg_simulation_ms << " ms\n";
     return 0;
 }
@@ -2,12 +2,18 @@
 
 #include <algorithm>
 #include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <set>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 #include "hypercuboid.h"
+#include "utils.h"
 
 template <typename T>
 std::set<T> set_minus(const std::set<T>& a, const std::set<T>& b)
@@ -167,6 +173,200 @@ void count_naive(state s, int count)
     std::cout << "Summary: totally " << legal_moves.size() << " options\n";
 }
 
+namespace
+{
+/*
+ checkpoint file layout, all integers little-endian:
+   "5DCK", u32 version, u64 position fingerprint, u64 emitted actions,
+   u64 output length, search_space::write() of the remaining space
+ */
+constexpr char checkpoint_magic[4] = {'5', 'D', 'C', 'K'};
+constexpr std::uint32_t checkpoint_version = 1;
+
+struct checkpoint_header
+{
+    std::uint64_t position = 0;
+    std::uint64_t emitted = 0;
+    std::uint64_t output_length = 0;
+};
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+// stays installed, so a repeated signal still ends with a saved checkpoint
+extern "C" void request_stop(int)
+{
+    stop_requested = 1;
+}
+
+// FNV-1a of the printed position, so a checkpoint is not resumed on another game
+std::uint64_t fingerprint(const state &s)
+{
+    std::uint64_t h = 0xcbf29ce484222325ull;
+    for(unsigned char c : s.to_string())
+    {
+        h ^= c;
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+void save_checkpoint(const std::string &path, const checkpoint_header &header, const search_space &ss)
+{
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(checkpoint_magic, sizeof checkpoint_magic);
+        write_le(out, checkpoint_version);
+        write_le(out, header.position);
+        write_le(out, header.emitted);
+        write_le(out, header.output_length);
+        ss.write(out);
+        out.flush();
+        if(!out)
+        {
+            throw std::runtime_error("cannot write checkpoint " + temporary);
+        }
+    }
+    // the previous checkpoint is only replaced by a complete one
+    std::filesystem::rename(temporary, path);
+}
+
+std::pair<checkpoint_header, search_space> load_checkpoint(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if(!in)
+    {
+        throw std::runtime_error("cannot open checkpoint " + path);
+    }
+    char magic[sizeof checkpoint_magic];
+    if(!in.read(magic, sizeof magic)
+       || !std::equal(std::begin(magic), std::end(magic), std::begin(checkpoint_magic)))
+    {
+        throw std::runtime_error(path + " is not a search checkpoint");
+    }
+    if(read_le<std::uint32_t>(in) != checkpoint_version)
+    {
+        throw std::runtime_error("unsupported checkpoint version in " + path);
+    }
+    checkpoint_header header;
+    header.position = read_le<std::uint64_t>(in);
+    header.emitted = read_le<std::uint64_t>(in);
+    header.output_length = read_le<std::uint64_t>(in);
+    search_space ss = search_space::read(in);
+    return {header, std::move(ss)};
+}
+}
+
+template<bool PRINT>
+void count_checkpointed(state s, int count, const checkpoint_options &options)
+{
+    auto [w, ss] = HC_info::build_HC(s);
+    checkpoint_header header;
+    header.position = fingerprint(s);
+    const bool resuming = std::filesystem::exists(options.checkpoint);
+    if(resuming)
+    {
+        auto [saved, remaining] = load_checkpoint(options.checkpoint);
+        if(saved.position != header.position)
+        {
+            throw std::runtime_error(options.checkpoint + " was saved for a different position");
+        }
+        header = saved;
+        ss = std::move(remaining);
+        std::cerr << "Resuming after " << header.emitted << " actions\n";
+    }
+
+    std::ofstream file;
+    if(options.output)
+    {
+        const std::string &path = *options.output;
+        if(resuming)
+        {
+            if(!std::filesystem::exists(path) || std::filesystem::file_size(path) < header.output_length)
+            {
+                throw std::runtime_error(path + " is shorter than recorded in " + options.checkpoint);
+            }
+            std::filesystem::resize_file(path, header.output_length);
+            file.open(path, std::ios::binary | std::ios::app);
+        }
+        else
+        {
+            file.open(path, std::ios::binary | std::ios::trunc);
+        }
+        if(!file)
+        {
+            throw std::runtime_error("cannot open " + path);
+        }
+    }
+    std::ostream &out = options.output ? static_cast<std::ostream &>(file) : std::cout;
+
+    auto save = [&](const search_space &remaining) {
+        out.flush();
+        if(options.output)
+        {
+            header.output_length = static_cast<std::uint64_t>(file.tellp());
+        }
+        save_checkpoint(options.checkpoint, header, remaining);
+    };
+
+    stop_requested = 0;
+    auto previous_int = std::signal(SIGINT, request_stop);
+    auto previous_term = std::signal(SIGTERM, request_stop);
+    const auto interval = std::chrono::seconds(options.interval_seconds);
+    auto last_save = std::chrono::steady_clock::now();
+    const auto limit_reached = [&]() {
+        return count > 0 && header.emitted >= static_cast<std::uint64_t>(count);
+    };
+    // runs between candidates too, so long runs of rejections are saved and stoppable
+    const auto checkpoint = [&]() {
+        if(stop_requested)
+        {
+            return false;
+        }
+        if(std::chrono::steady_clock::now() - last_save >= interval)
+        {
+            save(ss);
+            last_save = std::chrono::steady_clock::now();
+        }
+        return true;
+    };
+    if(!limit_reached())
+    {
+        for(const moveseq &x : w.resumable_search(ss, checkpoint))
+        {
+            if constexpr(PRINT)
+            {
+                state t = s;
+                for(full_move m : x)
+                {
+                    out << m.pgn(t, QUEEN_W, pgn_options::SHOW_CAPTURE) << " ";
+                    t.apply_move(m);
+                }
+                out << "\n";
+            }
+            header.emitted++;
+            if(limit_reached() || stop_requested)
+            {
+                break;
+            }
+        }
+    }
+    std::signal(SIGINT, previous_int);
+    std::signal(SIGTERM, previous_term);
+
+    if(ss.empty())
+    {
+        out.flush();
+        std::filesystem::remove(options.checkpoint);
+    }
+    else
+    {
+        save(ss);
+        std::cerr << "Checkpoint saved to " << options.checkpoint << "\n";
+    }
+    std::cout << "Summary: totally " << header.emitted << " options\n";
+}
+
 void diff(state s)
 {
     std::set<moveseq> legal_moves_hc, legal_moves_naive;
@@ -268,3 +468,5 @@ template void count_mixed<false>(state, int);
 template void count_mixed<true>(state, int);
 template void count_naive<false>(state, int);
 template void count_naive<true>(state, int);
+template void count_checkpointed<false>(state, int, const checkpoint_options &);
+template void count_checkpointed<true>(state, int, const checkpoint_options &);
@@ -2,6 +2,7 @@
 #define SEARCH_TOOLS_H
 
 #include <optional>
+#include <string>
 #include <utility>
 
 #include "state.h"
@@ -33,6 +34,32 @@ void count_mixed(state s, int count);
 template<bool PRINT=false>
 void count_naive(state s, int count);
 
+/*
+ count_checkpointed(): the balanced search, resumable across runs.
+ The remaining search space and the number of emitted actions are saved to
+ `checkpoint` every `interval_seconds`, when `count` actions were emitted in
+ total, and when the process gets SIGINT or SIGTERM. If the checkpoint file
+ exists, the search resumes from it instead of starting over; it is removed
+ once the search is exhausted. Actions are streamed and never stored.
+
+ With `output`, actions are appended to that file and the checkpoint records
+ its length, so a resumed run first cuts off whatever was written after the
+ checkpoint and every action appears exactly once. Without it they go to
+ stdout, where the actions after the last checkpoint are repeated on resume.
+
+ Throws std::runtime_error if the checkpoint is unreadable or belongs to a
+ different position.
+ */
+struct checkpoint_options
+{
+    std::string checkpoint;
+    std::optional<std::string> output;
+    int interval_seconds = 60;
+};
+
+template<bool PRINT=false>
+void count_checkpointed(state s, int count, const checkpoint_options &options);
+
 void diff(state s);
 
 #endif /* SEARCH_TOOLS_H */